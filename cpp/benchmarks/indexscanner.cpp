@@ -0,0 +1,185 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+
+// compares the line-by-line prescan of Packages/Sources files with the
+// anchor scanner; usage: indexscanner-benchmark <index file>...
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+#include <cupt/file.hpp>
+
+#include <internal/indexscanner.hpp>
+
+using namespace cupt;
+
+struct Result
+{
+	size_t recordCount;
+	size_t providesCount;
+	size_t offsetSum; // a cheap checksum of record offsets
+};
+
+static Result scanByLines(const string& path)
+{
+	Result result = { 0, 0, 0 };
+
+	string openError;
+	File file(path, "r", openError);
+	if (!openError.empty())
+	{
+		fatal2("unable to open the file '%s': %s", path, openError);
+	}
+
+	size_t offset = 0;
+	const char* buf;
+	size_t size;
+	while (file.rawGetLine(buf, size), offset += size, !file.eof())
+	{
+		// 'Package:' line
+		++result.recordCount;
+		result.offsetSum += offset;
+		while (file.rawGetLine(buf, size), offset += size, size > 1)
+		{
+			if (*buf == 'P' && size > 10 && !memcmp("rovides: ", buf+1, 9))
+			{
+				++result.providesCount;
+			}
+		}
+	}
+	return result;
+}
+
+static Result scanByAnchors(const string& data,
+		const char* (*findAnchorCandidate)(const char*, const char*))
+{
+	Result result = { 0, 0, 0 };
+
+	const char* const begin = data.data();
+	const char* const end = begin + data.size();
+	const char* recordBegin = begin;
+	while (recordBegin != end)
+	{
+		auto packageLineEnd = static_cast< const char* >(memchr(recordBegin, '\n', end - recordBegin));
+		++result.recordCount;
+		result.offsetSum += (packageLineEnd ? packageLineEnd + 1 : end) - begin;
+
+		const char* recordEnd = end;
+		const char* candidate = packageLineEnd ? packageLineEnd : end;
+		while ((candidate = findAnchorCandidate(candidate, end)) != end)
+		{
+			const char* lineBegin = candidate + 1;
+			if (*lineBegin == '\n')
+			{
+				recordEnd = lineBegin + 1;
+				break;
+			}
+			if (end - lineBegin > 10 && !memcmp("Provides: ", lineBegin, 10))
+			{
+				++result.providesCount;
+			}
+			candidate = lineBegin;
+		}
+		recordBegin = recordEnd;
+	}
+	return result;
+}
+
+static double getTime()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+template < typename Function >
+static Result measure(const string& name, size_t size, Function function)
+{
+	const int repeats = 5;
+	Result result = { 0, 0, 0 };
+	double best = 0;
+	for (int i = 0; i < repeats; ++i)
+	{
+		double start = getTime();
+		result = function();
+		double elapsed = getTime() - start;
+		if (i == 0 || elapsed < best)
+		{
+			best = elapsed;
+		}
+	}
+	printf("  %-24s %8.2f ms %9.1f MiB/s  (%zu records, %zu provides)\n", name.c_str(),
+			best * 1000, size / best / 1048576, result.recordCount, result.providesCount);
+	return result;
+}
+
+int main(int argc, char* argv[])
+{
+	messageFd = 2;
+	if (argc < 2)
+	{
+		fprintf(stderr, "usage: %s <index file>...\n", argv[0]);
+		return 1;
+	}
+
+	bool allMatched = true;
+	try
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			string path = argv[i];
+			string data;
+			{
+				string openError;
+				File file(path, "r", openError);
+				if (!openError.empty())
+				{
+					fatal2("unable to open the file '%s': %s", path, openError);
+				}
+				file.getFile(data);
+			}
+			printf("%s (%zu bytes):\n", path.c_str(), data.size());
+
+			auto reference = measure("lines (File::rawGetLine)", data.size(),
+					[&path]() { return scanByLines(path); });
+			auto scalar = measure("anchors (scalar)", data.size(),
+					[&data]() { return scanByAnchors(data, internal::scanner::findAnchorCandidateScalar); });
+			auto dispatched = measure(string("anchors (") + internal::scanner::getImplementationName() + ")",
+					data.size(), [&data]() { return scanByAnchors(data, internal::scanner::findAnchorCandidate); });
+
+			for (const Result* result: { &scalar, &dispatched })
+			{
+				if (result->recordCount != reference.recordCount ||
+						result->providesCount != reference.providesCount ||
+						result->offsetSum != reference.offsetSum)
+				{
+					printf("  MISMATCH against the line-by-line scan\n");
+					allMatched = false;
+				}
+			}
+		}
+	}
+	catch (Exception&)
+	{
+		return 1;
+	}
+
+	return allMatched ? 0 : 2;
+}
+
@@ -0,0 +1,119 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+
+// measures the native resolver on the upgrade of all installed packages;
+// usage: resolver-benchmark [<option>=<value>...]
+// the options are set in the configuration before reading the cache, for
+// example 'dir=/some/root/' or 'cupt::resolver::threads=4'
+
+#include <cstdio>
+#include <ctime>
+#include <sys/resource.h>
+
+#include <cupt/config.hpp>
+#include <cupt/cache.hpp>
+#include <cupt/cache/package.hpp>
+#include <cupt/system/resolvers/native.hpp>
+
+using namespace cupt;
+
+struct Result
+{
+	size_t packageCount;
+	size_t unresolvedProblemCount;
+};
+
+static Result resolve(const shared_ptr< const Config >& config, const shared_ptr< const Cache >& cache)
+{
+	Result result = { 0, 0 };
+
+	system::NativeResolver resolver(config, cache);
+	resolver.upgrade();
+	resolver.resolve([&result](const system::Resolver::Offer& offer)
+	{
+		result.packageCount = offer.suggestedPackages.size();
+		result.unresolvedProblemCount = offer.unresolvedProblems.size();
+		return system::Resolver::UserAnswer::Accept;
+	});
+	return result;
+}
+
+static double getTime()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static long getMaxResidentKilobytes()
+{
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+}
+
+int main(int argc, char* argv[])
+{
+	messageFd = 2;
+	// as the package management commands do
+	cache::Package::memoize = true;
+	Cache::memoize = true;
+	try
+	{
+		shared_ptr< Config > config(new Config);
+		for (int i = 1; i < argc; ++i)
+		{
+			string argument = argv[i];
+			auto position = argument.find('=');
+			if (position == string::npos)
+			{
+				fprintf(stderr, "usage: %s [<option>=<value>...]\n", argv[0]);
+				return 1;
+			}
+			config->setScalar(argument.substr(0, position), argument.substr(position + 1));
+		}
+
+		double start = getTime();
+		shared_ptr< const Cache > cache(new Cache(config, false, true, true));
+		printf("cache:    %8.2f ms, max resident %ld KiB\n",
+				(getTime() - start) * 1000, getMaxResidentKilobytes());
+
+		const int repeats = 3;
+		double best = 0;
+		Result result = { 0, 0 };
+		for (int i = 0; i < repeats; ++i)
+		{
+			start = getTime();
+			result = resolve(config, cache);
+			double elapsed = getTime() - start;
+			if (i == 0 || elapsed < best)
+			{
+				best = elapsed;
+			}
+		}
+		printf("resolver: %8.2f ms, max resident %ld KiB  (%zu packages, %zu unresolved problems)\n",
+				best * 1000, getMaxResidentKilobytes(),
+				result.packageCount, result.unresolvedProblemCount);
+	}
+	catch (Exception&)
+	{
+		return 1;
+	}
+
+	return 0;
+}
@@ -61,11 +61,6 @@ int downloadSourcePackage(Context& context)
 		fatal2(__("no source package expressions specified"));
 	}
 
-	if (!shellMode)
-	{
-		Version::parseInfoOnly = false;
-		Version::parseRelations = false;
-	}
 	auto cache = context.getCache(true, true, true);
 
 	vector< SourceVersion::FileParts::Type > partsToDownload = {
@@ -200,12 +195,6 @@ int downloadSourcePackage(Context& context)
 
 int downloadChangelogOrCopyright(Context& context, ChangelogOrCopyright::Type type)
 {
-	if (!shellMode)
-	{
-		Version::parseInfoOnly = false;
-		Version::parseRelations = false;
-	}
-
 	auto config = context.getConfig();
 
 	vector< string > arguments;
@@ -1194,12 +1194,6 @@ int managePackages(Context& context, ManagePackages::Mode mode)
 {
 	auto config = context.getConfig();
 
-	// turn off info parsing, we don't need it
-	if (!shellMode)
-	{
-		Version::parseInfoOnly = false;
-	}
-
 	Package::memoize = true;
 	Cache::memoize = true;
 
@@ -1412,12 +1406,6 @@ int changeAutoInstalledState(Context& context, bool value)
 
 int cleanArchives(Context& context, bool leaveAvailable)
 {
-	if (!shellMode)
-	{
-		Version::parseInfoOnly = false;
-		Version::parseRelations = false;
-	}
-
 	bpo::options_description noOptions;
 	vector< string > arguments;
 	auto variables = parseOptions(context, noOptions, arguments);
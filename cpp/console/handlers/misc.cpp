@@ -63,10 +63,6 @@ int showBinaryVersions(Context& context)
 		fatal2(__("no binary package expressions specified"));
 	}
 
-	if (!shellMode)
-	{
-		Version::parseOthers = true;
-	}
 	auto cache = context.getCache(/* source */ false, /* binary */ variables.count("installed-only") == 0,
 			/* installed */ true);
 
@@ -172,9 +168,9 @@ int showBinaryVersions(Context& context)
 			}
 			for (size_t i = 0; i < BinaryVersion::RelationTypes::Count; ++i)
 			{
-				p(__(BinaryVersion::RelationTypes::strings[i].c_str()), version->relations[i].toString());
+				p(__(BinaryVersion::RelationTypes::strings[i].c_str()), version->relations[i].get().toString());
 			}
-			p(__("Provides"), join(", ", version->provides));
+			p(__("Provides"), join(", ", version->provides.get()));
 			auto reverseProvides = getReverseProvides(packageName);
 			p(__("Provided by"), reverseProvides.toString());
 			{
@@ -209,16 +205,13 @@ int showBinaryVersions(Context& context)
 				}
 			}
 			p(__("Tags"), version->tags);
-			if (version->others)
+			FORIT(it, version->others.get())
 			{
-				FORIT(it, (*(version->others)))
+				if (it->first == "Description-md5")
 				{
-					if (it->first == "Description-md5")
-					{
-						continue;
-					}
-					p(it->first, it->second);
+					continue;
 				}
+				p(it->first, it->second);
 			}
 			cout << endl;
 		}
@@ -242,10 +235,6 @@ int showSourceVersions(Context& context)
 		fatal2(__("no source package expressions specified"));
 	}
 
-	if (!shellMode)
-	{
-		Version::parseOthers = true;
-	}
 	auto cache = context.getCache(/* source */ true, /* binary */ true, /* installed */ true);
 
 	auto p = printTag;
@@ -308,12 +297,9 @@ int showSourceVersions(Context& context)
 				}
 			}
 
-			if (version->others)
+			FORIT(it, version->others.get())
 			{
-				FORIT(it, (*(version->others)))
-				{
-					p(it->first, it->second);
-				}
+				p(it->first, it->second);
 			}
 			cout << endl;
 		}
@@ -323,12 +309,6 @@ int showSourceVersions(Context& context)
 }
 int showRelations(Context& context, bool reverse)
 {
-	// turn off info parsing, we don't need it, only relations :)
-	if (!shellMode)
-	{
-		Version::parseInfoOnly = false;
-	}
-
 	auto config = context.getConfig();
 
 	vector< string > arguments;
@@ -378,33 +358,6 @@ int showRelations(Context& context, bool reverse)
 	// don't output the same version more than one time
 	set< shared_ptr< const BinaryVersion >, PointerLess< const BinaryVersion > > processedVersions;
 
-	// used only by rdepends
-	unordered_map< string, set< string > > reverseDependsIndex;
-	if (reverse)
-	{
-		for (const string& packageName: cache->getBinaryPackageNames())
-		{
-			auto package = cache->getBinaryPackage(packageName);
-			auto versions = package->getVersions();
-			for (const auto& version: versions)
-			{
-				FORIT(relationGroupIt, relationGroups)
-				{
-					const RelationLine& relationLine = version->relations[*relationGroupIt];
-					FORIT(relationExpressionIt, relationLine)
-					{
-						auto satisfyingVersions = cache->getSatisfyingVersions(*relationExpressionIt);
-						FORIT(satisfyingVersionIt, satisfyingVersions)
-						{
-							const string& satisfyingPackageName = (*satisfyingVersionIt)->packageName;
-							reverseDependsIndex[satisfyingPackageName].insert(packageName);
-						}
-					}
-				}
-			}
-		}
-	}
-
 	bool recurse = config->getBool("apt::cache::recursedepends");
 	bool allVersions = config->getBool("apt::cache::allversions");
 
@@ -430,7 +383,7 @@ int showRelations(Context& context, bool reverse)
 			if (!reverse)
 			{
 				// just plain normal dependencies
-				for (const auto& relationExpression: version->relations[*relationGroupIt])
+				for (const auto& relationExpression: version->relations[*relationGroupIt].get())
 				{
 					cout << "  " << caption << ": " << relationExpression.toString() << endl;
 					if (recurse)
@@ -466,42 +419,24 @@ int showRelations(Context& context, bool reverse)
 			}
 			else
 			{
-				// we have to check all reverse dependencies for this version
-				auto packageCandidateNamesIt = reverseDependsIndex.find(packageName);
-				if (packageCandidateNamesIt != reverseDependsIndex.end())
+				auto reverseDependencies = cache->getReverseDependencies(version, *relationGroupIt);
+				const BinaryVersion* lastCandidateVersionPtr = NULL;
+				for (const auto& reverseDependency: reverseDependencies)
 				{
-					const set< string >& packageCandidateNames = packageCandidateNamesIt->second;
-					FORIT(packageCandidateNameIt, packageCandidateNames)
+					const auto& candidateVersion = reverseDependency.version;
+					if (candidateVersion.get() == lastCandidateVersionPtr)
 					{
-						auto packageCandidate = cache->getBinaryPackage(*packageCandidateNameIt);
-						auto candidateVersions = packageCandidate->getVersions();
+						continue; // only the first satisfied relation expression is shown
+					}
+					lastCandidateVersionPtr = candidateVersion.get();
 
-						for (const auto& candidateVersion: candidateVersions)
-						{
-							FORIT(relationExpressionIt, candidateVersion->relations[*relationGroupIt])
-							{
-								auto satisfyingVersions = cache->getSatisfyingVersions(*relationExpressionIt);
-								for (const auto& satisfyingVersion: satisfyingVersions)
-								{
-									if (*satisfyingVersion == *version)
-									{
-										// positive result
-										cout << "  " << __("Reverse-") << caption << ": "
-												<< candidateVersion->packageName << ' '
-												<< candidateVersion->versionString << ": "
-												<< relationExpressionIt->toString() << endl;
-										if (recurse)
-										{
-											versions.push(candidateVersion);
-										}
-
-										goto candidate;
-									}
-								}
-							}
-							candidate:
-							;
-						}
+					cout << "  " << __("Reverse-") << caption << ": "
+							<< candidateVersion->packageName << ' '
+							<< candidateVersion->versionString << ": "
+							<< reverseDependency.relationExpressionPtr->toString() << endl;
+					if (recurse)
+					{
+						versions.push(candidateVersion);
 					}
 				}
 			}
@@ -559,13 +494,6 @@ int policy(Context& context, bool source)
 {
 	auto config = context.getConfig();
 
-	// turn off info and relations parsing, we don't need it
-	if (!shellMode)
-	{
-		Version::parseInfoOnly = false;
-		Version::parseRelations = false;
-	}
-
 	vector< string > arguments;
 	bpo::options_description options("");
 	options.add_options()
@@ -748,12 +676,6 @@ int showPackageNames(Context& context)
 
 int findDependencyChain(Context& context)
 {
-	// turn off info parsing, we don't need it, only relations
-	if(!shellMode)
-	{
-		Version::parseInfoOnly = false;
-	}
-
 	vector< string > arguments;
 
 	bpo::options_description options("");
@@ -863,7 +785,7 @@ int findDependencyChain(Context& context)
 		{
 			auto dependencyType = *dependencyTypeIt;
 
-			FORIT(relationExpressionIt, version->relations[dependencyType])
+			FORIT(relationExpressionIt, version->relations[dependencyType].get())
 			{
 				// insert recursive depends into queue
 				auto satisfyingVersions = cache->getSatisfyingVersions(*relationExpressionIt);
@@ -33,11 +33,6 @@ int search(Context& context)
 	auto config = context.getConfig();
 	vector< string > patterns;
 
-	if (!shellMode)
-	{
-		BinaryVersion::parseRelations = false;
-	}
-
 	bpo::options_description options;
 	options.add_options()
 		("names-only,n", "")
@@ -50,10 +45,6 @@ int search(Context& context)
 	{
 		config->setScalar("apt::cache::namesonly", "yes");
 	}
-	if (!shellMode && config->getBool("apt::cache::namesonly"))
-	{
-		BinaryVersion::parseInfoOnly = false;
-	}
 
 	if (patterns.empty())
 	{
@@ -121,8 +112,8 @@ int search(Context& context)
 				bool matched = true;
 
 				auto descriptions = cache->getLocalizedDescriptions(v);
-				const string& shortDescription = descriptions.first.empty() ? v->shortDescription : descriptions.first;
-				const string& longDescription = descriptions.second.empty() ? v->longDescription : descriptions.second;
+				const string& shortDescription = descriptions.first.empty() ? v->shortDescription.get() : descriptions.first;
+				const string& longDescription = descriptions.second.empty() ? v->longDescription.get() : descriptions.second;
 
 				FORIT(regexIt, regexes)
 				{
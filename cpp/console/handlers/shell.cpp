@@ -158,7 +158,8 @@ void freeArgcArgv(int argc, char** argv)
 int shell(Context& context)
 {
 	shellMode = true;
-	Package::memoize = true;
+	// with a budget, the cache keeps only the recently used versions
+	Package::memoize = (context.getConfig()->getInteger("cupt::cache::version-memoization-budget") <= 0);
 
 	vector< string > arguments;
 	bpo::options_description noOptions;
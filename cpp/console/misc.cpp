@@ -322,34 +322,28 @@ shared_ptr< Config > Context::getConfig()
 }
 
 Context::Context()
-	: __used_source(false), __used_binary(false), __used_installed(false)
 {}
 
 shared_ptr< const Cache > Context::getCache(
 		bool useSource, bool useBinary, bool useInstalled,
 		const vector< string >& packageNameGlobsToReinstall)
 {
-	bool needsRebuild =
-			!__cache ||
-			!packageNameGlobsToReinstall.empty() ||
-			(useSource && !__used_source) ||
-			((useBinary != __used_binary || useInstalled != __used_installed) && (useBinary || useInstalled));
-
-	if (needsRebuild)
+	// the cache reads only the metadata it didn't read before
+	try
 	{
-		try
+		if (!__cache)
 		{
 			__cache.reset(new Cache(__config, useSource, useBinary, useInstalled, packageNameGlobsToReinstall));
 		}
-		catch (Exception&)
+		else
 		{
-			fatal2(__("error while creating the package cache"));
+			__cache->reconfigure(useSource, useBinary, useInstalled, packageNameGlobsToReinstall);
 		}
 	}
-
-	__used_source = useSource;
-	__used_binary = useBinary;
-	__used_installed = useInstalled;
+	catch (Exception&)
+	{
+		fatal2(__("error while creating the package cache"));
+	}
 
 	return __cache;
 }
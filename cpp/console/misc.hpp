@@ -29,9 +29,6 @@ class Context
 {
 	shared_ptr< Config > __config;
 	shared_ptr< Cache > __cache;
-	bool __used_source;
-	bool __used_binary;
-	bool __used_installed;
  public:
 	Context();
 
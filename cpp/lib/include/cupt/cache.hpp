@@ -27,6 +27,7 @@
 #include <cupt/common.hpp>
 #include <cupt/fwd.hpp>
 #include <cupt/hashsums.hpp>
+#include <cupt/cache/binaryversion.hpp>
 
 namespace cupt {
 
@@ -96,6 +97,23 @@ class CUPT_API Cache
 	/// destructor
 	virtual ~Cache();
 
+	/// changes the set of used package metadata
+	/**
+	 * Brings the cache to the state it would have if it was constructed with
+	 * these parameters. Metadata which was read once stays in memory and is
+	 * only hidden when not requested, so switching back and forth reads
+	 * each kind of metadata at most once.
+	 *
+	 * Packages and versions got before the call may be outdated after it.
+	 *
+	 * @param useSource whether to use source package metadata
+	 * @param useBinary whether to use binary package metadata
+	 * @param useInstalled whether to use dpkg metadata (installed binary packages)
+	 * @param packageNameGlobsToReinstall array of glob expressions, allow these packages to be re-installed
+	 */
+	void reconfigure(bool useSource, bool useBinary, bool useInstalled,
+			const vector< string >& packageNameGlobsToReinstall = vector< string >());
+
 	/// gets release data list of indexed metadata for binary packages
 	vector< shared_ptr< const ReleaseInfo > > getBinaryReleaseData() const;
 	/// gets release data list of indexed metadata for source packages
@@ -169,6 +187,30 @@ class CUPT_API Cache
 	/// gets list of binary versions which satisfy given relation expression
 	vector< shared_ptr< const BinaryVersion > > getSatisfyingVersions(const RelationExpression&) const;
 
+	/// a relation expression of a binary version
+	struct ReverseDependency
+	{
+		shared_ptr< const BinaryVersion > version; ///< the version which has the relation expression
+		const RelationExpression* relationExpressionPtr; ///< points into relations of @ref version
+	};
+	/// gets binary versions which have relations satisfied by a binary version
+	/**
+	 * The first call builds an index of relations of all available binary
+	 * versions, possibly in several threads (see the option
+	 * @c cupt::cache::reverse-dependency-index-threads); after that a call
+	 * takes time proportional to the size of its result. The index is
+	 * rebuilt if @ref reconfigure changes the set of used package metadata.
+	 *
+	 * @param version binary version
+	 * @param relationType type of relations to consider
+	 * @return relation expressions of type @a relationType satisfied by
+	 * @a version, ordered by package name of the versions having them, then
+	 * in the order of versions in their package, then in the order of
+	 * relation expressions in the version
+	 */
+	vector< ReverseDependency > getReverseDependencies(const shared_ptr< const BinaryVersion >& version,
+			BinaryVersion::RelationTypes::Type relationType) const;
+
 	/// gets extended info
 	const ExtendedInfo& getExtendedInfo() const;
 
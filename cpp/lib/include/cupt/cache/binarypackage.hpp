@@ -45,6 +45,8 @@ class CUPT_API BinaryPackage: public Package
 	BinaryPackage(const shared_ptr< const string >& binaryArchitecture, bool allowReinstall);
 	/// gets list of versions
 	vector< shared_ptr< const BinaryVersion > > getVersions() const;
+	/// gets versions without copying them
+	VersionRange< BinaryVersion > getVersionRange() const;
 	/// gets installed version
 	/**
 	 * @return installed version if exists, empty pointer if not
@@ -43,20 +43,37 @@ struct CUPT_API BinaryVersion: public Version
 	string sourcePackageName; ///< source package name
 	string sourceVersionString; ///< source version string
 	bool essential; ///< has version 'essential' flag?
-	RelationLine relations[RelationTypes::Count]; ///< relations with other binary versions
-	vector< string > provides; ///< array of virtual package names
-	string shortDescription; ///< short description
-	string longDescription; ///< long description
-	string tags; ///< tags
+	LazyField< RelationLine > relations[RelationTypes::Count]; ///< relations with other binary versions
+	LazyField< vector< string > > provides; ///< array of virtual package names
+	LazyField< string > shortDescription; ///< short description
+	LazyField< string > longDescription; ///< long description
+	LazyField< string > tags; ///< tags
 	FileRecord file; ///< Version::FileRecord
+	/// @cond
+	LazyField< string > _description_hash; // the value of 'Description-md5', also kept in 'others'
+	/// @endcond
 
 	bool isInstalled() const; ///< is version installed?
 	virtual bool areHashesEqual(const shared_ptr< const Version >& other) const;
 
 	/// parse version
 	static shared_ptr< BinaryVersion > parseFromFile(const Version::InitializationParameters&);
+	/// @cond
+	CUPT_LOCAL void _parse_from_file(const Version::InitializationParameters&); // into a new version
+	/// @endcond
+ private:
+	shared_ptr< File > __index_file; // keeps raw values of lazy fields alive
 };
 
+/// @cond
+template <>
+void LazyField< RelationLine >::__parse() const;
+template <>
+void LazyField< vector< string > >::__parse() const;
+template <>
+void LazyField< string >::__parse() const;
+/// @endcond
+
 } // namespace
 } // namespace
 
@@ -23,15 +23,126 @@
 #include <cupt/cache/version.hpp>
 
 namespace cupt {
+namespace internal {
+
+struct PackageContext;
+
+}
+
 namespace cache {
 
+/// a view of the versions of a package
+/**
+ * Doesn't copy the versions if the package memoizes them (see
+ * Package::memoize), holds the freshly parsed ones otherwise. Elements are
+ * plain pointers which are valid while the range or the package exists,
+ * there is no reference counting while iterating.
+ */
+template < typename VersionType >
+class VersionRange
+{
+	friend class Package;
+
+	typedef vector< shared_ptr< Version > > Storage;
+
+	Storage __parsed;
+	const Storage* __memoized; // NULL if the versions are in @ref __parsed
+
+	const Storage& __get_storage() const
+	{
+		return __memoized ? *__memoized : __parsed;
+	}
+ public:
+	/// constructs an empty range
+	VersionRange()
+		: __memoized(NULL)
+	{}
+	/// forward iterator
+	class Iterator
+	{
+		typename Storage::const_iterator __it;
+	 public:
+		/// @cond
+		explicit Iterator(typename Storage::const_iterator it)
+			: __it(it)
+		{}
+		/// @endcond
+		/// gets the version
+		const VersionType* operator*() const
+		{
+			return static_cast< const VersionType* >(__it->get());
+		}
+		/// member access
+		const VersionType* operator->() const
+		{
+			return **this;
+		}
+		/// gets the shared pointer to the version, for keeping it longer
+		shared_ptr< const VersionType > getShared() const
+		{
+			return std::static_pointer_cast< const VersionType >(*__it);
+		}
+		/// prefix increment
+		Iterator& operator++()
+		{
+			++__it;
+			return *this;
+		}
+		/// equality operator
+		bool operator==(const Iterator& other) const
+		{
+			return __it == other.__it;
+		}
+		/// inequality operator
+		bool operator!=(const Iterator& other) const
+		{
+			return __it != other.__it;
+		}
+	};
+
+	/// gets the iterator to the first version
+	Iterator begin() const
+	{
+		return Iterator(__get_storage().begin());
+	}
+	/// gets the past-the-end iterator
+	Iterator end() const
+	{
+		return Iterator(__get_storage().end());
+	}
+	/// gets the number of versions
+	size_t size() const
+	{
+		return __get_storage().size();
+	}
+	/// are there no versions?
+	bool empty() const
+	{
+		return __get_storage().empty();
+	}
+	/// gets the version by its position
+	const VersionType* operator[](size_t index) const
+	{
+		return static_cast< const VersionType* >(__get_storage()[index].get());
+	}
+	/// gets the shared pointer to the version by its position
+	shared_ptr< const VersionType > getShared(size_t index) const
+	{
+		return std::static_pointer_cast< const VersionType >(__get_storage()[index]);
+	}
+};
+
 /// a container for all versions of the same package name
 class CUPT_API Package
 {
 	mutable vector< Version::InitializationParameters > __unparsed_versions;
 	mutable vector< shared_ptr< Version > >* __parsed_versions;
+	shared_ptr< internal::PackageContext > __context;
 
 	CUPT_LOCAL void __merge_version(shared_ptr< Version >&&, vector< shared_ptr< Version > >& result) const;
+	// returns either memoized versions or 'parsed'
+	CUPT_LOCAL const vector< shared_ptr< Version > >& __get_versions(
+			vector< shared_ptr< Version > >& parsed) const;
 
 	Package(const Package&);
 	Package& operator=(const Package&);
@@ -40,6 +151,18 @@ class CUPT_API Package
 	shared_ptr< const string > _binary_architecture;
 
 	CUPT_LOCAL vector< shared_ptr< Version > > _get_versions() const;
+	template < typename VersionType >
+	VersionRange< VersionType > _get_version_range() const
+	{
+		VersionRange< VersionType > result;
+		const auto& versions = __get_versions(result.__parsed);
+		if (&versions != &result.__parsed)
+		{
+			result.__memoized = &versions;
+		}
+		return result;
+	}
+	CUPT_LOCAL const internal::PackageContext* _get_context() const; // NULL if not set
 	CUPT_LOCAL virtual shared_ptr< Version > _parse_version(const Version::InitializationParameters&) const = 0;
 	CUPT_LOCAL virtual bool _is_architecture_appropriate(const shared_ptr< const Version >&) const = 0;
 	/// @endcond
@@ -55,6 +178,8 @@ class CUPT_API Package
 	void addEntry(const Version::InitializationParameters&);
 	/// gets list of versions
 	vector< shared_ptr< const Version > > getVersions() const;
+	/// gets versions without copying them
+	VersionRange< Version > getVersionRange() const;
 	/// gets version with a certain Version::versionString
 	/**
 	 * @return version if found, empty pointer if not found
@@ -62,7 +187,16 @@ class CUPT_API Package
 	 */
 	shared_ptr< const Version > getSpecificVersion(const string& versionString) const;
 
+	/// @cond
+	CUPT_LOCAL void _set_context(const shared_ptr< internal::PackageContext >&);
+	CUPT_LOCAL const vector< Version::InitializationParameters >& _get_entries() const;
+	/// @endcond
+
 	/// memoize parsed versions
+	/**
+	 * If not set, the cache may still keep parsed versions of recently used
+	 * packages, see the option 'cupt::cache::version-memoization-budget'.
+	 */
 	static bool memoize;
 };
 
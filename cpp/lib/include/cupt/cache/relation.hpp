@@ -21,16 +21,30 @@
 /// @file
 
 #include <cupt/common.hpp>
+#include <cupt/fwd.hpp>
 
 namespace cupt {
+namespace internal {
+namespace relationparser {
+
+struct Record;
+
+}
+
+class RelationExpressionMemo;
+
+}
+
 namespace cache {
 
 /// %relation against certain binary package
 struct CUPT_API Relation
 {
  private:
-	CUPT_LOCAL bool __parse_versioned_info(string::const_iterator, string::const_iterator);
-	CUPT_LOCAL void __init(string::const_iterator, string::const_iterator);
+	const string* __version_key; // sortable form of versionString, NULL if not computed
+
+	CUPT_LOCAL void __init(const internal::relationparser::Record&);
+	CUPT_LOCAL void __init(const char*, const char*);
  public:
 	/// %relation type
 	struct Types
@@ -56,6 +70,9 @@ struct CUPT_API Relation
 	 * @param input pair of begin iterator and end iterator of stringified relation
 	 */
 	explicit Relation(pair< string::const_iterator, string::const_iterator > input);
+	/// @cond
+	CUPT_LOCAL explicit Relation(const internal::relationparser::Record&);
+	/// @endcond
 	Relation(Relation&&) = default;
 	Relation(const Relation&) = default;
 	Relation& operator=(Relation&&) = default;
@@ -73,6 +90,15 @@ struct CUPT_API Relation
 	 * @return @c true if satisfied, @c false if not
 	 */
 	bool isSatisfiedBy(const string& otherVersionString) const;
+	/// is relation satisfied by @a version
+	/**
+	 * Same as @ref isSatisfiedBy(const string&) const called with the version
+	 * string of @a version, but faster for versions got from a cache.
+	 *
+	 * @param version version to check
+	 * @return @c true if satisfied, @c false if not
+	 */
+	bool isSatisfiedBy(const Version& version) const;
 	/// operator ==
 	/**
 	 * @param other relation to compare with
@@ -85,7 +111,7 @@ struct CUPT_API Relation
 struct CUPT_API ArchitecturedRelation: public Relation
 {
  private:
-	CUPT_LOCAL void __init(string::const_iterator, string::const_iterator);
+	CUPT_LOCAL void __init(const char*, const char*);
  public:
 	/// architecture filters
 	vector< string > architectureFilters;
@@ -114,7 +140,15 @@ struct CUPT_API ArchitecturedRelation: public Relation
 struct CUPT_API RelationExpression: public vector< Relation >
 {
  private:
-	CUPT_LOCAL void __init(string::const_iterator, string::const_iterator);
+	friend class internal::RelationExpressionMemo;
+
+	// the memo which looked the expression up last and the index of its
+	// entry there; only a hint, as the entry is compared with the contents
+	// on every use
+	mutable const void* __memo_owner;
+	mutable uint32_t __memo_index;
+
+	CUPT_LOCAL void __init(const char*, const char*);
  public:
 	/// gets the string representation
 	string toString() const;
@@ -180,7 +214,7 @@ struct CUPT_API ArchitecturedRelationExpression: public vector< ArchitecturedRel
 struct CUPT_API RelationLine: public vector< RelationExpression >
 {
  private:
-	CUPT_LOCAL void __init(string::const_iterator, string::const_iterator);
+	CUPT_LOCAL void __init(const char*, const char*);
  public:
 	/// gets the string representation
 	string toString() const;
@@ -20,6 +20,8 @@
 
 /// @file
 
+#include <cstdint>
+
 #include <cupt/common.hpp>
 
 namespace cupt {
@@ -43,6 +45,12 @@ struct CUPT_API ReleaseInfo
 	string baseUri; ///< source base URI
 	bool notAutomatic; ///< @c true, if @c NotAutomatic flag is specified in Release file
 	bool butAutomaticUpgrades; ///< @c true, if @c ButAutomaticUpgrades flag is specified in Release file
+	/**
+	 * small dense number of the release among releases of the cache it comes
+	 * from, usable as a key; within one cache, release infos with equal
+	 * identifiers are the same object
+	 */
+	uint32_t id;
 };
 
 }
@@ -41,6 +41,8 @@ class CUPT_API SourcePackage: public Package
 	 */
 	SourcePackage(const shared_ptr< const string >& binaryArchitecture);
 	vector< shared_ptr< const SourceVersion > > getVersions() const;
+	/// gets versions without copying them
+	VersionRange< SourceVersion > getVersionRange() const;
 };
 
 }
@@ -58,6 +58,9 @@ struct CUPT_API SourceVersion: public Version
 
 	/// parse version
 	static shared_ptr< SourceVersion > parseFromFile(const Version::InitializationParameters&);
+	/// @cond
+	CUPT_LOCAL void _parse_from_file(const Version::InitializationParameters&); // into a new version
+	/// @endcond
 };
 
 } // namespace
@@ -22,16 +22,105 @@
 
 #include <cstdint>
 #include <map>
+#include <atomic>
 
 #include <cupt/fwd.hpp>
 #include <cupt/common.hpp>
 #include <cupt/hashsums.hpp>
 
 namespace cupt {
+namespace internal {
+namespace versionkey {
+
+struct Access;
+
+}
+}
+
 namespace cache {
 
 using std::map;
 
+/// a version field which is parsed on the first access
+/**
+ * Versions read from memory-mapped index files remember only where the
+ * values of rarely needed fields are, these fields are parsed when they are
+ * accessed for the first time. Versions created otherwise hold plain values.
+ *
+ * Reading the field (including the first access) is safe from several
+ * threads at once; changing it is not.
+ */
+template < typename T >
+class CUPT_API LazyField
+{
+	mutable T __value;
+	mutable std::atomic< const char* > __raw_begin; // NULL if the value is parsed
+	mutable const char* __raw_end;
+
+	void __parse() const;
+	template < typename Parser >
+	void __parse_once(const Parser&) const;
+ public:
+	/// constructor
+	LazyField()
+		: __raw_begin(NULL), __raw_end(NULL)
+	{}
+	/// copy constructor, the copy holds the parsed value
+	LazyField(const LazyField& other)
+		: __value(other.get()), __raw_begin(NULL), __raw_end(NULL)
+	{}
+	/// copy assignment operator, the field gets the parsed value
+	LazyField& operator=(const LazyField& other)
+	{
+		return (*this = other.get());
+	}
+	/// gets the value, parsing it if needed
+	const T& get() const
+	{
+		if (__raw_begin.load(std::memory_order_acquire))
+		{
+			__parse();
+		}
+		return __value;
+	}
+	/// @copydoc get
+	T& get()
+	{
+		if (__raw_begin.load(std::memory_order_acquire))
+		{
+			__parse();
+		}
+		return __value;
+	}
+	/// @copydoc get
+	operator const T&() const
+	{
+		return get();
+	}
+	/// sets the value
+	LazyField& operator=(const T& value)
+	{
+		__value = value;
+		__raw_begin.store(NULL, std::memory_order_relaxed);
+		return *this;
+	}
+	/// @cond
+	void setRaw(const char* begin, const char* end)
+	{
+		__value = T();
+		__raw_end = end;
+		__raw_begin.store(begin, std::memory_order_release);
+	}
+	// gets the raw range if the value is not parsed yet
+	bool getRaw(const char*& begin, const char*& end) const
+	{
+		begin = __raw_begin.load(std::memory_order_acquire);
+		end = __raw_end;
+		return (begin != NULL);
+	}
+	/// @endcond
+};
+
 /// common version information
 /**
  * @see SourceVersion and BinaryVersion
@@ -79,7 +168,13 @@ struct CUPT_API Version
 	string section; ///< section
 	string maintainer; ///< maintainer (usually name and mail address)
 	string versionString; ///< version
-	map< string, string >* others; ///< unknown fields in the form 'name' -> 'value', @c NULL by default
+	LazyField< map< string, string > > others; ///< unknown fields in the form 'name' -> 'value'
+ private:
+	/// @cond
+	friend struct internal::versionkey::Access;
+	string __version_key; // sortable form of versionString, empty if not computed
+	/// @endcond
+ public:
 
 	/// constructor
 	Version();
@@ -109,14 +204,19 @@ struct CUPT_API Version
 	 */
 	bool operator==(const Version&) const;
 
-	/// enables parsing relation fields in versions, @c true by default
+	/// @deprecated has no effect, rarely needed fields are parsed on demand
 	static bool parseRelations;
-	/// enables parsing info-only fields in versions, @c true by default
+	/// @copydoc parseRelations
 	static bool parseInfoOnly;
-	/// enables parsing unknown fields in versions, @c false by default
+	/// @copydoc parseRelations
 	static bool parseOthers;
 };
 
+/// @cond
+template <>
+void LazyField< map< string, string > >::__parse() const;
+/// @endcond
+
 } // namespace
 } // namespace
 
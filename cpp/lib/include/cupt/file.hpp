@@ -46,7 +46,9 @@ class CUPT_API File
 	 * @param path path to file or shell command, see @a mode
 	 * @param mode any value, accepted as @a mode in @c fopen(3); or @c "pr" /
 	 *   @c "pw" - special values to treat @a path as shell pipe with an opened
-	 *   handle for reading / writing, respectively
+	 *   handle for reading / writing, respectively; or @c "m" - special value
+	 *   to read the whole regular file into memory at once, so @ref rawGetLine
+	 *   and @ref rawGetRecord return pointers into it without copying
 	 * @param [out] error if open fails, human readable error will be placed here
 	 */
 	File(const string& path, const char* mode, string& error);
@@ -101,6 +103,18 @@ class CUPT_API File
 	 * @return reference to self.
 	 */
 	File& getRecord(string& record);
+	/// reads new record
+	/**
+	 * Same as @ref getRecord, but doesn't copy the data for files opened
+	 * with the mode @c "m".
+	 *
+	 * @param [out] buffer will contain a pointer to read data, valid until
+	 * the next read operation on a non-mapped file or until the destruction
+	 * of the object for a mapped one
+	 * @param [out] size the size (in bytes) of the buffer
+	 * @return reference to self.
+	 */
+	File& rawGetRecord(const char*& buffer, size_t& size);
 	/// reads new block
 	/**
 	 * Reads up to @a size characters from current position to @a buffer.
@@ -134,6 +148,13 @@ class CUPT_API File
 
 	/// checks for the end of file condition
 	bool eof() const;
+	/// is the file read into memory at once?
+	/**
+	 * @return @c true if the file was opened in the mode @c "m"; buffers
+	 * returned by reading functions of such file stay valid while the file
+	 * object exists
+	 */
+	bool isMapped() const;
 	/// seeks to a new position
 	/**
 	 * Sets new position of the file to write/read.
@@ -22,12 +22,14 @@
 #include <cupt/cache.hpp>
 #include <cupt/cache/binarypackage.hpp>
 #include <cupt/cache/binaryversion.hpp>
+#include <cupt/cache/releaseinfo.hpp>
 #include <cupt/system/state.hpp>
 
 #include <internal/cacheimpl.hpp>
-#include <internal/regex.hpp>
 #include <internal/cachefiles.hpp>
 #include <internal/filesystem.hpp>
+#include <internal/versionlru.hpp>
+#include <internal/versionkey.hpp>
 
 // TODO/API break/: remove deprecated entities
 
@@ -41,10 +43,10 @@ Cache::Cache(shared_ptr< const Config > config, bool useSource, bool useBinary,
 	__impl = new internal::CacheImpl;
 	__impl->config = config;
 	__impl->binaryArchitecture.reset(new string(config->getString("apt::architecture")));
-
-	FORIT(it, packageNameGlobsToReinstall)
+	auto versionMemoizationBudget = config->getInteger("cupt::cache::version-memoization-budget");
+	if (versionMemoizationBudget > 0)
 	{
-		__impl->packageNameRegexesToReinstall.push_back(internal::globToRegex(*it));
+		__impl->packageContext->versionLru.reset(new internal::lru::VersionLru(versionMemoizationBudget));
 	}
 
 	{ // ugly hack to copy trusted keyring from APT whenever possible, see #647001
@@ -63,17 +65,16 @@ Cache::Cache(shared_ptr< const Config > config, bool useSource, bool useBinary,
 	}
 
 	__impl->parseSourcesLists();
-
-	if (useInstalled)
-	{
-		__impl->systemState.reset(new system::State(config, __impl));
-	}
-
-	__impl->processIndexEntries(useBinary, useSource);
-	__impl->parsePreferences();
+	__impl->load(useSource, useBinary, useInstalled, packageNameGlobsToReinstall);
 	__impl->parseExtendedStates();
 }
 
+void Cache::reconfigure(bool useSource, bool useBinary, bool useInstalled,
+		const vector< string >& packageNameGlobsToReinstall)
+{
+	__impl->load(useSource, useBinary, useInstalled, packageNameGlobsToReinstall);
+}
+
 Cache::~Cache()
 {
 	delete __impl;
@@ -81,11 +82,23 @@ Cache::~Cache()
 
 vector< shared_ptr< const ReleaseInfo > > Cache::getBinaryReleaseData() const
 {
-	return __impl->binaryReleaseData;
+	vector< shared_ptr< const ReleaseInfo > > result;
+	FORIT(it, __impl->binaryReleaseData)
+	{
+		if ((*it)->baseUri.empty() ? __impl->useInstalled : __impl->useBinary)
+		{
+			result.push_back(*it);
+		}
+	}
+	return result;
 }
 
 vector< shared_ptr< const ReleaseInfo > > Cache::getSourceReleaseData() const
 {
+	if (!__impl->useSource)
+	{
+		return vector< shared_ptr< const ReleaseInfo > >();
+	}
 	return __impl->sourceReleaseData;
 }
 
@@ -126,22 +139,12 @@ vector< Cache::LocalizationDownloadRecord > Cache::getDownloadInfoOfLocalizedDes
 
 vector< string > Cache::getBinaryPackageNames() const
 {
-	vector< string > result;
-	FORIT(it, __impl->preBinaryPackages)
-	{
-		result.push_back(it->first);
-	}
-	return result;
+	return __impl->getBinaryPackageNames();
 }
 
 vector< string > Cache::getSourcePackageNames() const
 {
-	vector< string > result;
-	FORIT(it, __impl->preSourcePackages)
-	{
-		result.push_back(it->first);
-	}
-	return result;
+	return __impl->getSourcePackageNames();
 }
 
 shared_ptr< const BinaryPackage > Cache::getBinaryPackage(const string& packageName) const
@@ -201,9 +204,20 @@ vector< Cache::PinnedVersion > Cache::getSortedPinnedVersions(const shared_ptr<
 		return installedVersionString;
 	};
 
-	for (const auto& version: versions)
+	if (Cache::memoize)
+	{
+		for (const auto& version: versions)
+		{
+			result.push_back(PinnedVersion(version, __impl->getPin(version, getInstalledVersionString)));
+		}
+	}
+	else
 	{
-		result.push_back(PinnedVersion(version, __impl->getPin(version, getInstalledVersionString)));
+		auto pins = __impl->getPins(versions, getInstalledVersionString());
+		for (size_t i = 0; i < versions.size(); ++i)
+		{
+			result.push_back(PinnedVersion(versions[i], pins[i]));
+		}
 	}
 
 	auto sorter = [](const PinnedVersion& left, const PinnedVersion& right) -> bool
@@ -218,7 +232,7 @@ vector< Cache::PinnedVersion > Cache::getSortedPinnedVersions(const shared_ptr<
 		}
 		else
 		{
-			return compareVersionStrings(left.version->versionString, right.version->versionString) > 0;
+			return internal::versionkey::compare(*left.version, *right.version) > 0;
 		}
 	};
 	std::stable_sort(result.begin(), result.end(), sorter);
@@ -243,6 +257,10 @@ shared_ptr< const Version > Cache::getPolicyVersion(const shared_ptr< const Pack
 
 shared_ptr< const system::State > Cache::getSystemState() const
 {
+	if (!__impl->useInstalled)
+	{
+		return shared_ptr< const system::State >();
+	}
 	return __impl->systemState;
 }
 
@@ -257,9 +275,19 @@ Cache::getSatisfyingVersions(const RelationExpression& relationExpression) const
 	return __impl->getSatisfyingVersions(relationExpression);
 }
 
+vector< Cache::ReverseDependency > Cache::getReverseDependencies(const shared_ptr< const BinaryVersion >& version,
+		BinaryVersion::RelationTypes::Type relationType) const
+{
+	return __impl->getReverseDependencies(version, relationType);
+}
+
 vector< shared_ptr< const BinaryVersion > > Cache::getInstalledVersions() const
 {
 	vector< shared_ptr< const BinaryVersion > > result;
+	if (!__impl->useInstalled)
+	{
+		return result;
+	}
 
 	auto packageNames = __impl->systemState->getInstalledPackageNames();
 	result.reserve(packageNames.size());
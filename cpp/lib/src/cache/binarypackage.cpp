@@ -19,6 +19,8 @@
 #include <cupt/cache/binarypackage.hpp>
 #include <cupt/cache/binaryversion.hpp>
 
+#include <internal/packagecontext.hpp>
+
 namespace cupt {
 namespace cache {
 
@@ -28,7 +30,10 @@ BinaryPackage::BinaryPackage(const shared_ptr< const string >& binaryArchitectur
 
 shared_ptr< Version > BinaryPackage::_parse_version(const Version::InitializationParameters& initParams) const
 {
-	auto version = BinaryVersion::parseFromFile(initParams);
+	// versions live in the memory of the cache while there is one
+	auto context = _get_context();
+	auto version = internal::arena::makeShared< BinaryVersion >(context ? context->arena : NULL);
+	version->_parse_from_file(initParams);
 	if (__allow_reinstall && version->isInstalled())
 	{
 		version->versionString += "~installed";
@@ -49,22 +54,28 @@ bool BinaryPackage::_is_architecture_appropriate(const shared_ptr< const Version
 
 vector< shared_ptr< const BinaryVersion > > BinaryPackage::getVersions() const
 {
-	auto source = _get_versions();
+	auto source = getVersionRange();
 	vector< shared_ptr< const BinaryVersion > > result;
-	FORIT(it, source)
+	result.reserve(source.size());
+	for (auto it = source.begin(); it != source.end(); ++it)
 	{
-		result.push_back(static_pointer_cast< const BinaryVersion >(*it));
+		result.push_back(it.getShared());
 	}
 	return result;
 }
 
+VersionRange< BinaryVersion > BinaryPackage::getVersionRange() const
+{
+	return _get_version_range< BinaryVersion >();
+}
+
 shared_ptr< const BinaryVersion > BinaryPackage::getInstalledVersion() const
 {
-	auto source = getVersions();
+	auto source = getVersionRange();
 	if (!source.empty() && source[0]->isInstalled())
 	{
 		// here we rely on the fact that installed version (if exists) adds first to the cache/package
-		return source[0];
+		return source.getShared(0);
 	}
 	else
 	{
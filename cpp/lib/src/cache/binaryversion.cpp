@@ -15,6 +15,8 @@
 *   Free Software Foundation, Inc.,                                       *
 *   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
 **************************************************************************/
+#include <mutex>
+
 #include <cupt/file.hpp>
 #include <cupt/cache/binaryversion.hpp>
 #include <cupt/cache/releaseinfo.hpp>
@@ -22,13 +24,154 @@
 #include <internal/tagparser.hpp>
 #include <internal/versionparsemacro.hpp>
 #include <internal/common.hpp>
+#include <internal/relationparser.hpp>
 
 namespace cupt {
 namespace cache {
 
+namespace {
+
+// keeps the raw range of the value to parse it on demand if the range stays
+// valid, parses the value immediately otherwise
+template < typename T >
+void setLazyField(LazyField< T >& field, const internal::TagParser::StringRange& value, bool lazy)
+{
+	field.setRaw(&*value.first, &*value.second);
+	if (!lazy)
+	{
+		field.get();
+	}
+}
+
+// a malformed relation line fails the parsing of the version, as it did
+// before the relations became lazy, and not the first access to the field
+void setLazyRelationField(LazyField< RelationLine >& field,
+		const internal::TagParser::StringRange& value, bool lazy, bool check)
+{
+	if (lazy && check)
+	{
+		internal::relationparser::checkLine(&*value.first, &*value.second);
+	}
+	setLazyField(field, value, lazy);
+}
+
+// unrecognized tags go to 'others' if it's not NULL
+void parseTags(BinaryVersion* v, internal::TagParser& parser, Version::Source& source,
+		bool lazy, map< string, string >* others)
+{
+	typedef BinaryVersion::RelationTypes RelationTypes;
+
+	// the unknown fields are reparsed out of an already checked record
+	const bool checkRelations = !others;
+
+	internal::TagParser::StringRange tagName, tagValue;
+
+	while (parser.parseNextLine(tagName, tagValue))
+	{
+		TAG(Version, v->versionString = tagValue;)
+		TAG(Essential, v->essential = (string(tagValue) == "yes");)
+		PARSE_PRIORITY
+		TAG(Size, v->file.size = internal::string2uint32(tagValue);)
+		TAG(Installed-Size, v->installedSize = internal::string2uint32(tagValue) * 1024;)
+		TAG(Architecture, v->architecture = tagValue;)
+		TAG(Filename,
+		{
+			string filename = tagValue;
+			auto lastSlashPosition = filename.find_last_of('/');
+			if (lastSlashPosition == string::npos)
+			{
+				// source.directory remains empty
+				v->file.name = filename;
+			}
+			else
+			{
+				source.directory = filename.substr(0, lastSlashPosition);
+				v->file.name = filename.substr(lastSlashPosition + 1);
+			}
+		})
+		TAG(MD5sum, v->file.hashSums[HashSums::MD5] = tagValue;)
+		TAG(SHA1, v->file.hashSums[HashSums::SHA1] = tagValue;)
+		TAG(SHA256, v->file.hashSums[HashSums::SHA256] = tagValue;)
+		TAG(Source,
+		{
+			v->sourcePackageName = tagValue;
+			string& value = v->sourcePackageName;
+			// determing do we have source version appended or not?
+			// example: "abcd (1.2-5)"
+			auto size = value.size();
+			if (size > 2 && value[size-1] == ')')
+			{
+				auto delimiterPosition = value.rfind('(', size-2);
+				if (delimiterPosition != string::npos)
+				{
+					// found! there is a source version, most probably
+					// indicating that it was some binary-only rebuild, and
+					// the source version is different with binary one
+					v->sourceVersionString = value.substr(delimiterPosition+1, size-delimiterPosition-2);
+					checkVersionString(v->sourceVersionString);
+					if (delimiterPosition != 0 && value[delimiterPosition-1] == ' ')
+					{
+						--delimiterPosition;
+					}
+					v->sourcePackageName.erase(delimiterPosition);
+				}
+			}
+		};)
+
+		TAG(Pre-Depends, setLazyRelationField(v->relations[RelationTypes::PreDepends], tagValue, lazy, checkRelations);)
+		TAG(Depends, setLazyRelationField(v->relations[RelationTypes::Depends], tagValue, lazy, checkRelations);)
+		TAG(Recommends, setLazyRelationField(v->relations[RelationTypes::Recommends], tagValue, lazy, checkRelations);)
+		TAG(Suggests, setLazyRelationField(v->relations[RelationTypes::Suggests], tagValue, lazy, checkRelations);)
+		TAG(Conflicts, setLazyRelationField(v->relations[RelationTypes::Conflicts], tagValue, lazy, checkRelations);)
+		TAG(Breaks, setLazyRelationField(v->relations[RelationTypes::Breaks], tagValue, lazy, checkRelations);)
+		TAG(Replaces, setLazyRelationField(v->relations[RelationTypes::Replaces], tagValue, lazy, checkRelations);)
+		TAG(Enhances, setLazyRelationField(v->relations[RelationTypes::Enhances], tagValue, lazy, checkRelations);)
+		TAG(Provides, setLazyField(v->provides, tagValue, lazy);)
+
+		TAG(Section, v->section = tagValue;)
+		TAG(Maintainer, v->maintainer = tagValue;)
+		TAG(Description,
+		{
+			setLazyField(v->shortDescription, tagValue, lazy);
+			if (lazy)
+			{
+				internal::TagParser::StringRange lines;
+				parser.parseAdditionalLines(lines);
+				v->longDescription.setRaw(&*lines.first, &*lines.second);
+			}
+			else
+			{
+				string lines;
+				parser.parseAdditionalLines(lines);
+				v->longDescription = lines;
+			}
+		};)
+		TAG(Tag, setLazyField(v->tags, tagValue, lazy);)
+
+		// the translation lookup needs it without parsing all unknown fields
+		if (tagName.equal(BUFFER_AND_SIZE("Description-md5")))
+		{
+			setLazyField(v->_description_hash, tagValue, lazy);
+		}
+		if (others && !tagName.equal(BUFFER_AND_SIZE("Package")) && !tagName.equal(BUFFER_AND_SIZE("Status")))
+		{
+			(*others)[string(tagName)] = tagValue;
+		}
+	}
+}
+
+}
+
 shared_ptr< BinaryVersion > BinaryVersion::parseFromFile(const Version::InitializationParameters& initParams)
 {
-	auto v = std::make_shared< BinaryVersion >();
+	auto result = std::make_shared< BinaryVersion >();
+	result->_parse_from_file(initParams);
+	return result;
+}
+
+void BinaryVersion::_parse_from_file(const Version::InitializationParameters& initParams)
+{
+	auto v = this;
 
 	Source source;
 
@@ -44,93 +187,25 @@ shared_ptr< BinaryVersion > BinaryVersion::parseFromFile(const Version::Initiali
 		// go to starting byte of the entry
 		initParams.file->seek(initParams.offset);
 
-		internal::TagParser parser(initParams.file.get());
-		internal::TagParser::StringRange tagName, tagValue;
+		// values in a memory mapping stay valid, so rarely needed fields may
+		// be parsed later, on the first access
+		bool lazy = initParams.file->isMapped();
 
-		while (parser.parseNextLine(tagName, tagValue))
+		internal::TagParser parser(initParams.file.get());
+		if (lazy)
 		{
-			TAG(Version, v->versionString = tagValue;)
-			TAG(Essential, v->essential = (string(tagValue) == "yes");)
-			PARSE_PRIORITY
-			TAG(Size, v->file.size = internal::string2uint32(tagValue);)
-			TAG(Installed-Size, v->installedSize = internal::string2uint32(tagValue) * 1024;)
-			TAG(Architecture, v->architecture = tagValue;)
-			TAG(Filename,
-			{
-				string filename = tagValue;
-				auto lastSlashPosition = filename.find_last_of('/');
-				if (lastSlashPosition == string::npos)
-				{
-					// source.directory remains empty
-					v->file.name = filename;
-				}
-				else
-				{
-					source.directory = filename.substr(0, lastSlashPosition);
-					v->file.name = filename.substr(lastSlashPosition + 1);
-				}
-			})
-			TAG(MD5sum, v->file.hashSums[HashSums::MD5] = tagValue;)
-			TAG(SHA1, v->file.hashSums[HashSums::SHA1] = tagValue;)
-			TAG(SHA256, v->file.hashSums[HashSums::SHA256] = tagValue;)
-			TAG(Source,
-			{
-				v->sourcePackageName = tagValue;
-				string& value = v->sourcePackageName;
-				// determing do we have source version appended or not?
-				// example: "abcd (1.2-5)"
-				auto size = value.size();
-				if (size > 2 && value[size-1] == ')')
-				{
-					auto delimiterPosition = value.rfind('(', size-2);
-					if (delimiterPosition != string::npos)
-					{
-						// found! there is a source version, most probably
-						// indicating that it was some binary-only rebuild, and
-						// the source version is different with binary one
-						v->sourceVersionString = value.substr(delimiterPosition+1, size-delimiterPosition-2);
-						checkVersionString(v->sourceVersionString);
-						if (delimiterPosition != 0 && value[delimiterPosition-1] == ' ')
-						{
-							--delimiterPosition;
-						}
-						v->sourcePackageName.erase(delimiterPosition);
-					}
-				}
-			};)
+			const char* recordBegin;
+			size_t recordSize;
+			initParams.file->rawGetRecord(recordBegin, recordSize);
+			initParams.file->seek(initParams.offset);
 
-			if (Version::parseRelations)
-			{
-				TAG(Pre-Depends, v->relations[RelationTypes::PreDepends] = RelationLine(tagValue);)
-				TAG(Depends, v->relations[RelationTypes::Depends] = RelationLine(tagValue);)
-				TAG(Recommends, v->relations[RelationTypes::Recommends] = RelationLine(tagValue);)
-				TAG(Suggests, v->relations[RelationTypes::Suggests] = RelationLine(tagValue);)
-				TAG(Conflicts, v->relations[RelationTypes::Conflicts] = RelationLine(tagValue);)
-				TAG(Breaks, v->relations[RelationTypes::Breaks] = RelationLine(tagValue);)
-				TAG(Replaces, v->relations[RelationTypes::Replaces] = RelationLine(tagValue);)
-				TAG(Enhances, v->relations[RelationTypes::Enhances] = RelationLine(tagValue);)
-				TAG(Provides,
-				{
-					auto callback = [&v](string::const_iterator begin, string::const_iterator end)
-					{
-						v->provides.push_back(string(begin, end));
-					};
-					internal::processSpaceCommaSpaceDelimitedStrings(tagValue.first, tagValue.second, callback);
-				})
-			}
-
-			if (Version::parseInfoOnly)
-			{
-				TAG(Section, v->section = tagValue;)
-				TAG(Maintainer, v->maintainer = tagValue;)
-				TAG(Description,
-				{
-					v->shortDescription = tagValue;
-					parser.parseAdditionalLines(v->longDescription);
-				};)
-				TAG(Tag, v->tags = tagValue;)
-				PARSE_OTHERS
-			}
+			v->__index_file = initParams.file;
+			parseTags(v, parser, source, true, NULL);
+			v->others.setRaw(recordBegin, recordBegin + recordSize);
+		}
+		else
+		{
+			parseTags(v, parser, source, false, &v->others.get());
 		}
 
 		checkVersionString(v->versionString);
@@ -159,8 +234,6 @@ shared_ptr< BinaryVersion > BinaryVersion::parseFromFile(const Version::Initiali
 	{
 		fatal2(__("no hash sums specified"));
 	}
-
-	return v;
 }
 
 bool BinaryVersion::isInstalled() const
@@ -178,6 +251,81 @@ bool BinaryVersion::areHashesEqual(const shared_ptr< const Version >& other) con
 	return file.hashSums.match(o->file.hashSums);
 }
 
+namespace {
+
+// first accesses to different fields of the same version are independent
+// enough to not share one lock
+std::mutex lazyFieldParseMutexes[16];
+
+std::mutex& getLazyFieldParseMutex(const void* field)
+{
+	return lazyFieldParseMutexes[(reinterpret_cast< uintptr_t >(field) / sizeof(void*)) %
+			(sizeof(lazyFieldParseMutexes) / sizeof(lazyFieldParseMutexes[0]))];
+}
+
+}
+
+template < typename T >
+template < typename Parser >
+void LazyField< T >::__parse_once(const Parser& parser) const
+{
+	std::lock_guard< std::mutex > lock(getLazyFieldParseMutex(this));
+	auto rawBegin = __raw_begin.load(std::memory_order_relaxed);
+	if (rawBegin) // otherwise another thread has parsed it meanwhile
+	{
+		parser(rawBegin, __raw_end);
+		__raw_begin.store(NULL, std::memory_order_release);
+	}
+}
+
+template <>
+void LazyField< RelationLine >::__parse() const
+{
+	__parse_once([this](const char* begin, const char* end)
+	{
+		__value.clear();
+		internal::relationparser::buildLine(begin, end, __value);
+	});
+}
+
+template <>
+void LazyField< vector< string > >::__parse() const
+{
+	__parse_once([this](const char* begin, const char* end)
+	{
+		__value.clear();
+		auto callback = [this](const char* tokenBegin, const char* tokenEnd)
+		{
+			__value.push_back(string(tokenBegin, tokenEnd));
+		};
+		internal::processSpaceCommaSpaceDelimitedStrings(begin, end, callback);
+	});
+}
+
+template <>
+void LazyField< string >::__parse() const
+{
+	__parse_once([this](const char* begin, const char* end)
+	{
+		__value.assign(begin, end);
+	});
+}
+
+// only binary versions have lazy unknown fields, the raw value is the
+// whole record, which is reparsed to find what is not recognized
+template <>
+void LazyField< map< string, string > >::__parse() const
+{
+	__parse_once([this](const char* begin, const char* end)
+	{
+		BinaryVersion unused;
+		Version::Source unusedSource;
+		internal::TagParser parser(begin, end);
+		__value.clear();
+		parseTags(&unused, parser, unusedSource, true, &__value);
+	});
+}
+
 const string BinaryVersion::RelationTypes::strings[] = {
 	N__("Pre-Depends"), N__("Depends"), N__("Recommends"), N__("Suggests"),
 	N__("Enhances"), N__("Conflicts"), N__("Breaks"), N__("Replaces")
@@ -18,64 +18,113 @@
 
 #include <algorithm>
 #include <cstring>
+#include <mutex>
 
 #include <cupt/cache/package.hpp>
 #include <cupt/cache/releaseinfo.hpp>
 #include <cupt/cache/binaryversion.hpp>
 
+#include <internal/packagecontext.hpp>
+#include <internal/versionkey.hpp>
+
 namespace cupt {
 namespace cache {
 
 bool Package::memoize = false;
 
+namespace {
+
+// parsing versions changes the package, see Package::__get_versions; the
+// packages share a small set of locks instead of having one each
+std::mutex& getParseLock(const Package* package)
+{
+	static std::mutex locks[64];
+	return locks[reinterpret_cast< uintptr_t >(package) / sizeof(void*) % 64];
+}
+
+}
+
 Package::Package(const shared_ptr< const string >& binaryArchitecture)
 	: __parsed_versions(NULL), _binary_architecture(binaryArchitecture)
 {}
 
+void Package::_set_context(const shared_ptr< internal::PackageContext >& context)
+{
+	__context = context;
+}
+
+const internal::PackageContext* Package::_get_context() const
+{
+	return __context.get();
+}
+
+const vector< Version::InitializationParameters >& Package::_get_entries() const
+{
+	return __unparsed_versions;
+}
+
 void Package::addEntry(const Version::InitializationParameters& initParams)
 {
 	__unparsed_versions.push_back(initParams);
 }
 
-vector< shared_ptr< Version > > Package::_get_versions() const
+const vector< shared_ptr< Version > >& Package::__get_versions(vector< shared_ptr< Version > >& parsed) const
 {
 	if (! __parsed_versions)
 	{
 		// versions were either not parsed or parsed, but not saved
-		vector< shared_ptr< Version > > result;
+		parsed.clear();
+		auto versionLru = __context ? __context->versionLru.get() : NULL;
+		if (!memoize && versionLru && versionLru->get(this, parsed))
+		{
+			return parsed;
+		}
+
+		std::lock_guard< std::mutex > lock(getParseLock(this));
+		if (__parsed_versions)
+		{
+			return *__parsed_versions; // memoized by another thread meanwhile
+		}
 
-		vector< Version::InitializationParameters > newUnparsedVersions;
-		FORIT(unparsedVersionIt, __unparsed_versions)
+		// records which failed to parse are dropped
+		vector< size_t > failedRecordIndexes;
+		for (size_t i = 0; i < __unparsed_versions.size(); ++i)
 		{
-			Version::InitializationParameters& initParams = *unparsedVersionIt;
+			const Version::InitializationParameters& initParams = __unparsed_versions[i];
 			try
 			{
-				__merge_version(_parse_version(initParams), result);
-				if (!memoize)
-				{
-					newUnparsedVersions.push_back(initParams);
-				}
+				__merge_version(_parse_version(initParams), parsed);
 			}
 			catch (Exception& e)
 			{
 				warn2(__("error while parsing a version for the package '%s'"), initParams.packageName);
+				failedRecordIndexes.push_back(i);
 			}
 		}
-		if (result.empty())
+		if (parsed.empty())
 		{
 			warn2(__("no valid versions available, discarding the package"));
 		}
-		__unparsed_versions.swap(newUnparsedVersions);
 
+		// the entries are kept even if versions are memoized, the cache
+		// rebuilds packages from them
+		for (auto indexIt = failedRecordIndexes.rbegin(); indexIt != failedRecordIndexes.rend(); ++indexIt)
+		{
+			__unparsed_versions.erase(__unparsed_versions.begin() + *indexIt);
+		}
 		if (memoize)
 		{
 			__parsed_versions = new vector< shared_ptr< Version > >();
-			__parsed_versions->swap(result);
+			__parsed_versions->swap(parsed);
 			return *__parsed_versions;
 		}
 		else
 		{
-			return result;
+			if (versionLru)
+			{
+				versionLru->put(this, parsed);
+			}
+			return parsed;
 		}
 	}
 	else
@@ -84,6 +133,17 @@ vector< shared_ptr< Version > > Package::_get_versions() const
 	}
 }
 
+vector< shared_ptr< Version > > Package::_get_versions() const
+{
+	vector< shared_ptr< Version > > parsed;
+	const auto& versions = __get_versions(parsed);
+	if (&versions != &parsed)
+	{
+		return versions;
+	}
+	return parsed;
+}
+
 vector< shared_ptr< const Version > > Package::getVersions() const
 {
 	auto source = _get_versions();
@@ -92,6 +152,11 @@ vector< shared_ptr< const Version > > Package::getVersions() const
 	return result;
 }
 
+VersionRange< Version > Package::getVersionRange() const
+{
+	return _get_version_range< Version >();
+}
+
 void Package::__merge_version(shared_ptr< Version >&& parsedVersion, vector< shared_ptr< Version > >& result) const
 {
 	if (!_is_architecture_appropriate(parsedVersion))
@@ -99,6 +164,9 @@ void Package::__merge_version(shared_ptr< Version >&& parsedVersion, vector< sha
 		return; // skip this version
 	}
 
+	// the version string doesn't change from now on
+	internal::versionkey::set(*parsedVersion);
+
 	// merging
 	try
 	{
@@ -177,6 +245,10 @@ shared_ptr< const Version > Package::getSpecificVersion(const string& versionStr
 
 Package::~Package()
 {
+	if (__context && __context->versionLru)
+	{
+		__context->versionLru->erase(this);
+	}
 	delete __parsed_versions;
 }
 
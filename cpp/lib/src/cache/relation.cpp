@@ -21,143 +21,57 @@
 #include <cupt/cache/relation.hpp>
 
 #include <internal/common.hpp>
+#include <internal/relationparser.hpp>
+#include <internal/versionkey.hpp>
 
 namespace cupt {
 namespace cache {
 
-bool Relation::__parse_versioned_info(string::const_iterator current, string::const_iterator end)
+namespace {
+
+typedef pair< string::const_iterator, string::const_iterator > StringRange;
+
+// the characters of a possibly empty string range
+inline pair< const char*, const char* > getCharacters(const StringRange& input)
 {
-	// parse relation
-	if (current == end || current+1 == end /* version should at least have one character */)
-	{
-		return false;
-	}
-	switch (*current)
-	{
-		case '>':
-		{
-			if (*(current+1) == '=')
-			{
-				relationType = Types::MoreOrEqual;
-				current += 2;
-			}
-			else if (*(current+1) == '>')
-			{
-				relationType = Types::More;
-				current += 2;
-			}
-			else
-			{
-				relationType = Types::More;
-				current += 1;
-			}
-		}
-		break;
-		case '=':
-		{
-			relationType = Types::Equal;
-			current += 1;
-		}
-		break;
-		case '<':
-		{
-			if (*(current+1) == '=')
-			{
-				relationType = Types::LessOrEqual;
-				current += 2;
-			}
-			else if (*(current+1) == '<')
-			{
-				relationType = Types::Less;
-				current += 2;
-			}
-			else
-			{
-				relationType = Types::Less;
-				current += 1;
-			}
-		}
-		break;
-		default:
-			return false;
-	}
-	while (current != end && *current == ' ')
-	{
-		++current;
-	}
-	string::const_iterator versionStringEnd = current+1;
-	while (versionStringEnd != end && *versionStringEnd != ')' && *versionStringEnd != ' ')
-	{
-		++versionStringEnd;
-	}
-	if (versionStringEnd == end)
-	{
-		return false; // at least ')' after version string should be
-	}
-	versionString.assign(current, versionStringEnd);
-	checkVersionString(versionString);
+	const char* begin = (input.first != input.second) ? &*input.first : NULL;
+	return { begin, begin + (input.second - input.first) };
+}
 
-	current = versionStringEnd;
-	while (current != end && *current == ' ')
-	{
-		++current;
-	}
-	if (current == end || *current != ')')
-	{
-		return false;
-	}
-	++current;
-	while (current != end && *current == ' ')
-	{
-		++current;
-	}
-	return (current == end);
 }
 
-void Relation::__init(string::const_iterator start, string::const_iterator end)
+void Relation::__init(const internal::relationparser::Record& record)
 {
-	string::const_iterator current;
-	consumePackageName(start, end, current);
-	if (current != start)
+	__version_key = record.versionKey;
+	packageName = *record.packageName;
+	relationType = record.relationType;
+	if (record.versionString)
 	{
-		// package name is here
-		packageName.assign(start, current);
-	}
-	else
-	{
-		// no package name, bad
-		string unparsed(start, end);
-		fatal2(__("failed to parse a package name in the relation '%s'"), unparsed);
+		versionString = *record.versionString;
 	}
+}
 
-	while (current != end && *current == ' ')
-	{
-		++current;
-	}
-	if (current != end && *current == '(')
-	{
-		++current;
-		// okay, here we should have a versoined info
-		if (!__parse_versioned_info(current, end))
-		{
-			string unparsed(start, end);
-			fatal2(__("failed to parse a version part in the relation '%s'"), unparsed);
-		}
-	}
-	else
-	{
-		relationType = Types::None;
-	}
+void Relation::__init(const char* begin, const char* end)
+{
+	internal::relationparser::Record record;
+	internal::relationparser::parseRelation(begin, end, record);
+	__init(record);
+}
+
+Relation::Relation(const internal::relationparser::Record& record)
+{
+	__init(record);
 }
 
 Relation::Relation(pair< string::const_iterator, string::const_iterator > input)
 {
-	__init(input.first, input.second);
+	auto characters = getCharacters(input);
+	__init(characters.first, characters.second);
 }
 
 Relation::Relation(const string& unparsed)
 {
-	__init(unparsed.begin(), unparsed.end());
+	__init(unparsed.data(), unparsed.data() + unparsed.size());
 }
 
 Relation::~Relation()
@@ -180,27 +94,18 @@ bool Relation::isSatisfiedBy(const string& otherVersionString) const
 	{
 		return true;
 	}
-	else
+	return internal::relationparser::isComparisonResultSatisfying(relationType,
+			compareVersionStrings(otherVersionString, versionString));
+}
+
+bool Relation::isSatisfiedBy(const Version& version) const
+{
+	if (relationType == Types::None)
 	{
-		// relation is defined, checking
-		auto comparisonResult = compareVersionStrings(otherVersionString, versionString);
-		switch (relationType)
-		{
-			case Types::MoreOrEqual:
-				return (comparisonResult >= 0);
-			case Types::Less:
-				return (comparisonResult < 0);
-			case Types::LessOrEqual:
-				return (comparisonResult <= 0);
-			case Types::Equal:
-				return (comparisonResult == 0);
-			case Types::More:
-				return (comparisonResult > 0);
-			case Types::None:
-				__builtin_unreachable();
-		}
+		return true;
 	}
-	__builtin_unreachable();
+	return internal::relationparser::isComparisonResultSatisfying(relationType, internal::versionkey::compare(
+			internal::versionkey::get(version), version.versionString, __version_key, versionString));
 }
 
 bool Relation::operator==(const Relation& other) const
@@ -212,26 +117,36 @@ bool Relation::operator==(const Relation& other) const
 
 const string Relation::Types::strings[] = { "<<", "=", ">>", "<=", ">=" };
 
-void ArchitecturedRelation::__init(string::const_iterator start, string::const_iterator end)
+void ArchitecturedRelation::__init(const char* begin, const char* end)
 {
-	if (start == end)
+	if (begin == end)
 	{
 		return; // no architecture filters
 	}
-	if (*start != '[' || *(end-1) != ']')
+	if (*begin != '[' || *(end-1) != ']')
 	{
-		fatal2(__("unable to parse architecture filters '%s'"), string(start, end));
+		fatal2(__("unable to parse architecture filters '%s'"), string(begin, end));
 	}
-	++start;
+	++begin;
 	--end;
 
-	architectureFilters = internal::split(' ', string(start, end));
+	// space-separated, empty ones are skipped
+	while (begin != end)
+	{
+		auto filterEnd = std::find(begin, end, ' ');
+		if (filterEnd != begin)
+		{
+			architectureFilters.push_back(string(begin, filterEnd));
+		}
+		begin = (filterEnd != end) ? filterEnd + 1 : end;
+	}
 }
 
 ArchitecturedRelation::ArchitecturedRelation(const string& unparsed)
-		: Relation(string(unparsed.begin(), std::find(unparsed.begin(), unparsed.end(), '[')))
+		: Relation(make_pair(unparsed.begin(), std::find(unparsed.begin(), unparsed.end(), '[')))
 {
-	__init(std::find(unparsed.begin(), unparsed.end(), '['), unparsed.end());
+	auto filtersBegin = unparsed.data() + (std::find(unparsed.begin(), unparsed.end(), '[') - unparsed.begin());
+	__init(filtersBegin, unparsed.data() + unparsed.size());
 }
 
 // TODO/API break/: make this constructor explicit too
@@ -239,7 +154,8 @@ ArchitecturedRelation::ArchitecturedRelation(
 		pair< string::const_iterator, string::const_iterator > input)
 	: Relation(make_pair(input.first, std::find(input.first, input.second, '[')))
 {
-	__init(std::find(input.first, input.second, '['), input.second);
+	auto characters = getCharacters(make_pair(std::find(input.first, input.second, '['), input.second));
+	__init(characters.first, characters.second);
 }
 
 string ArchitecturedRelation::toString() const
@@ -367,41 +283,100 @@ string RelationExpression::getHashString() const
 }
 
 
+void RelationExpression::__init(const char* begin, const char* end)
+{
+	internal::relationparser::buildExpression(begin, end, *this);
+}
+
+RelationExpression::RelationExpression()
+	: __memo_owner(NULL), __memo_index(0)
+{}
+
+RelationExpression::RelationExpression(pair< string::const_iterator, string::const_iterator > input)
+	: __memo_owner(NULL), __memo_index(0)
+{
+	auto characters = getCharacters(input);
+	__init(characters.first, characters.second);
+}
+
+RelationExpression::RelationExpression(const string& expression)
+	: __memo_owner(NULL), __memo_index(0)
+{
+	__init(expression.data(), expression.data() + expression.size());
+}
+
+void ArchitecturedRelationExpression::__init(string::const_iterator begin, string::const_iterator end)
+{
+	for (auto it = begin; it != end; ++it)
+	{
+		if (*it == '|')
+		{
+			// split OR groups
+			auto callback = [this](string::const_iterator begin, string::const_iterator end)
+			{
+				this->emplace_back(make_pair(begin, end));
+			};
+			internal::processSpacePipeSpaceDelimitedStrings(begin, end, callback);
+			return;
+		}
+	}
+
+	// if we reached here, we didn't find OR groups
+	emplace_back(make_pair(begin, end));
+}
+
+ArchitecturedRelationExpression::ArchitecturedRelationExpression()
+{}
+
+ArchitecturedRelationExpression::ArchitecturedRelationExpression(
+		pair< string::const_iterator, string::const_iterator > input)
+{
+	__init(input.first, input.second);
+}
+
+ArchitecturedRelationExpression::ArchitecturedRelationExpression(const string& expression)
+{
+	__init(expression.begin(), expression.end());
+}
+
+void RelationLine::__init(const char* begin, const char* end)
+{
+	internal::relationparser::buildLine(begin, end, *this);
+}
+
+RelationLine::RelationLine(pair< string::const_iterator, string::const_iterator > input)
+{
+	auto characters = getCharacters(input);
+	__init(characters.first, characters.second);
+}
+
+RelationLine::RelationLine(const string& line)
+{
+	__init(line.data(), line.data() + line.size());
+}
+
+void ArchitecturedRelationLine::__init(string::const_iterator begin, string::const_iterator end)
+{
+	auto callback = [this](string::const_iterator begin, string::const_iterator end)
+	{
+		this->emplace_back(make_pair(begin, end));
+	};
+
+	internal::processSpaceCommaSpaceDelimitedStrings(begin, end, callback);
+}
+
+ArchitecturedRelationLine::ArchitecturedRelationLine(pair< string::const_iterator, string::const_iterator > input)
+{
+	__init(input.first, input.second);
+}
+
+ArchitecturedRelationLine::ArchitecturedRelationLine(const string& line)
+{
+	__init(line.begin(), line.end());
+}
+
 // yes, I know about templates, but here they cause just too much trouble
 #define DEFINE_RELATION_EXPRESSION_CLASS(RelationExpressionType, UnderlyingElement) \
-void RelationExpressionType::__init(string::const_iterator begin, string::const_iterator end) \
-{ \
-	for (auto it = begin; it != end; ++it) \
-	{ \
-		if (*it == '|') \
-		{ \
-			/* split OR groups */ \
-			auto callback = [this](string::const_iterator begin, string::const_iterator end) \
-			{ \
-				this->emplace_back(make_pair(begin, end)); \
-			}; \
-			internal::processSpacePipeSpaceDelimitedStrings(begin, end, callback); \
-			return; \
-		} \
-	} \
- \
-	/* if we reached here, we didn't find OR groups */ \
-	emplace_back(make_pair(begin, end)); \
-} \
- \
-RelationExpressionType::RelationExpressionType() \
-{} \
- \
-RelationExpressionType::RelationExpressionType(pair< string::const_iterator, string::const_iterator > input) \
-{ \
-	__init(input.first, input.second); \
-} \
- \
-RelationExpressionType::RelationExpressionType(const string& expression) \
-{ \
-	__init(expression.begin(), expression.end()); \
-} \
-\
 RelationExpressionType::~RelationExpressionType() \
 {} \
  \
@@ -423,26 +398,6 @@ DEFINE_RELATION_EXPRESSION_CLASS(ArchitecturedRelationExpression, ArchitecturedR
 RelationLineType::RelationLineType() \
 {} \
  \
-void RelationLineType::__init(string::const_iterator begin, string::const_iterator end) \
-{ \
-	auto callback = [this](string::const_iterator begin, string::const_iterator end) \
-	{ \
-		this->emplace_back(make_pair(begin, end)); \
-	}; \
- \
-	internal::processSpaceCommaSpaceDelimitedStrings(begin, end, callback); \
-} \
- \
-RelationLineType::RelationLineType(pair< string::const_iterator, string::const_iterator > input) \
-{ \
-	__init(input.first, input.second); \
-} \
- \
-RelationLineType::RelationLineType(const string& line) \
-{ \
-	__init(line.begin(), line.end()); \
-} \
- \
 RelationLineType& RelationLineType::operator=(RelationLineType&& other) \
 { \
 	std::vector< UnderlyingElement >::swap(other); \
@@ -20,6 +20,7 @@
 #include <cupt/cache/sourceversion.hpp>
 
 #include <internal/common.hpp>
+#include <internal/packagecontext.hpp>
 
 namespace cupt {
 namespace cache {
@@ -30,7 +31,11 @@ SourcePackage::SourcePackage(const shared_ptr< const string >& binaryArchitectur
 
 shared_ptr< Version > SourcePackage::_parse_version(const Version::InitializationParameters& initParams) const
 {
-	return SourceVersion::parseFromFile(initParams);
+	// versions live in the memory of the cache while there is one
+	auto context = _get_context();
+	auto version = internal::arena::makeShared< SourceVersion >(context ? context->arena : NULL);
+	version->_parse_from_file(initParams);
+	return version;
 }
 
 bool SourcePackage::_is_architecture_appropriate(const shared_ptr< const Version >& version) const
@@ -48,15 +53,21 @@ bool SourcePackage::_is_architecture_appropriate(const shared_ptr< const Version
 
 vector< shared_ptr< const SourceVersion > > SourcePackage::getVersions() const
 {
-	auto source = _get_versions();
+	auto source = getVersionRange();
 	vector< shared_ptr< const SourceVersion > > result;
-	FORIT(it, source)
+	result.reserve(source.size());
+	for (auto it = source.begin(); it != source.end(); ++it)
 	{
-		result.push_back(static_pointer_cast< const SourceVersion >(*it));
+		result.push_back(it.getShared());
 	}
 	return result;
 }
 
+VersionRange< SourceVersion > SourcePackage::getVersionRange() const
+{
+	return _get_version_range< SourceVersion >();
+}
+
 }
 }
 
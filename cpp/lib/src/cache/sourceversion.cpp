@@ -31,7 +31,14 @@ namespace cache {
 
 shared_ptr< SourceVersion > SourceVersion::parseFromFile(const Version::InitializationParameters& initParams)
 {
-	auto v = std::make_shared< SourceVersion >();
+	auto result = std::make_shared< SourceVersion >();
+	result->_parse_from_file(initParams);
+	return result;
+}
+
+void SourceVersion::_parse_from_file(const Version::InitializationParameters& initParams)
+{
+	auto v = this;
 
 	Source source;
 
@@ -138,22 +145,16 @@ shared_ptr< SourceVersion > SourceVersion::parseFromFile(const Version::Initiali
 			PARSE_PRIORITY
 			TAG(Architecture, v->architectures = internal::split(' ', tagValue);)
 
-			if (Version::parseRelations)
-			{
-				TAG(Build-Depends, v->relations[RelationTypes::BuildDepends] = ArchitecturedRelationLine(tagValue);)
-				TAG(Build-Depends-Indep, v->relations[RelationTypes::BuildDependsIndep] = ArchitecturedRelationLine(tagValue);)
-				TAG(Build-Conflicts, v->relations[RelationTypes::BuildConflicts] = ArchitecturedRelationLine(tagValue);)
-				TAG(Build-Conflicts-Indep, v->relations[RelationTypes::BuildConflictsIndep] = ArchitecturedRelationLine(tagValue);)
-			}
+			TAG(Build-Depends, v->relations[RelationTypes::BuildDepends] = ArchitecturedRelationLine(tagValue);)
+			TAG(Build-Depends-Indep, v->relations[RelationTypes::BuildDependsIndep] = ArchitecturedRelationLine(tagValue);)
+			TAG(Build-Conflicts, v->relations[RelationTypes::BuildConflicts] = ArchitecturedRelationLine(tagValue);)
+			TAG(Build-Conflicts-Indep, v->relations[RelationTypes::BuildConflictsIndep] = ArchitecturedRelationLine(tagValue);)
 
-			if (Version::parseInfoOnly)
-			{
-				TAG(Section, v->section = tagValue;)
-				TAG(Maintainer, v->maintainer = tagValue;)
-				static const sregex commaSeparatedRegex = sregex::compile("\\s*,\\s*", regex_constants::optimize);
-				TAG(Uploaders, v->uploaders = split(commaSeparatedRegex, tagValue);)
-				PARSE_OTHERS
-			}
+			TAG(Section, v->section = tagValue;)
+			TAG(Maintainer, v->maintainer = tagValue;)
+			static const sregex commaSeparatedRegex = sregex::compile("\\s*,\\s*", regex_constants::optimize);
+			TAG(Uploaders, v->uploaders = split(commaSeparatedRegex, tagValue);)
+			PARSE_OTHERS
 		}
 	}
 	checkVersionString(v->versionString);
@@ -170,8 +171,6 @@ shared_ptr< SourceVersion > SourceVersion::parseFromFile(const Version::Initiali
 		v->architectures.push_back("all");
 	}
 	// no need to verify hash sums for emptyness, it's guarantted by parsing algorithm above
-
-	return v;
 }
 
 bool SourceVersion::areHashesEqual(const shared_ptr< const Version >& other) const
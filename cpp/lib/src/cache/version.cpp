@@ -28,12 +28,12 @@ namespace cache {
 
 using std::set;
 
+// TODO/API break/: remove
 bool Version::parseRelations = true;
 bool Version::parseInfoOnly = true;
 bool Version::parseOthers = false;
 
 Version::Version()
-	: others(NULL)
 {}
 
 bool Version::isVerified() const
@@ -101,9 +101,7 @@ const string Version::Priorities::strings[] = {
 };
 
 Version::~Version()
-{
-	delete others;
-}
+{}
 
 }
 }
@@ -104,13 +104,17 @@ void ConfigImpl::initializeVariables()
 		{ "dir::log::terminal", "term.log" },
 
 		// Cupt vars
+		{ "cupt::cache::index-loading-threads", "0" },
 		{ "cupt::cache::limit-releases::by-archive::type", "none" },
 		{ "cupt::cache::limit-releases::by-codename::type", "none" },
 		{ "cupt::cache::pin::addendums::downgrade", "-10000" },
 		{ "cupt::cache::pin::addendums::hold", "1000000" },
 		{ "cupt::cache::pin::addendums::not-automatic", "-4000" },
 		{ "cupt::cache::pin::addendums::but-automatic-upgrades", "4200" },
+		{ "cupt::cache::persistent-index", "yes" },
 		{ "cupt::cache::release-file-expiration::ignore", "no" },
+		{ "cupt::cache::reverse-dependency-index-threads", "0" },
+		{ "cupt::cache::version-memoization-budget", "0" },
 		{ "cupt::console::allow-untrusted", "no" },
 		{ "cupt::console::assume-yes", "no" },
 		{ "cupt::console::actions-preview::show-archives", "no" },
@@ -163,6 +167,7 @@ void ConfigImpl::initializeVariables()
 		{ "cupt::resolver::max-solution-count", "512" },
 		{ "cupt::resolver::no-remove", "no" },
 		{ "cupt::resolver::synchronize-by-source-versions", "none" },
+		{ "cupt::resolver::threads", "1" },
 		{ "cupt::resolver::track-reasons", "no" },
 		{ "cupt::resolver::type", "fair" },
 		{ "cupt::resolver::score::new", "-5" },
@@ -186,6 +191,7 @@ void ConfigImpl::initializeVariables()
 		{ "cupt::worker::purge", "no" },
 		{ "cupt::worker::simulate", "no" },
 		{ "cupt::worker::use-locks", "yes" },
+		{ "debug::cache", "no" },
 		{ "debug::downloader", "no" },
 		{ "debug::logger", "no" },
 		{ "debug::resolver", "no" },
@@ -25,6 +25,7 @@
 #include <cupt/file.hpp>
 
 #include <internal/common.hpp>
+#include <internal/mappedfile.hpp>
 
 namespace cupt {
 
@@ -48,16 +49,34 @@ struct FileImpl
 	const string path;
 	bool isPipe;
 
+	// for files read into memory at once
+	bool isMapped;
+	std::unique_ptr< MappedFile > contents;
+	const char* mapBegin;
+	const char* mapEnd;
+	const char* position;
+	bool mapEof;
+
+	string recordBuffer; // for rawGetRecord on non-mapped files
+
 	FileImpl(const string& path_, const char* mode, string& openError);
 	~FileImpl();
+	void openMapped(string& openError);
 	inline size_t getLineImpl();
+	inline void getMappedLine(const char*& buffer, size_t& size);
 	inline void assertFileOpened() const;
 };
 
 FileImpl::FileImpl(const string& path_, const char* mode, string& openError)
-	: handle(NULL), buf(NULL), bufLength(0), path(path_), isPipe(false)
+	: handle(NULL), buf(NULL), bufLength(0), path(path_), isPipe(false),
+	isMapped(false), mapBegin(NULL), mapEnd(NULL), position(NULL), mapEof(false)
 {
-	if (mode[0] == 'p')
+	if (!strcmp(mode, "m"))
+	{
+		openMapped(openError);
+		return;
+	}
+	else if (mode[0] == 'p')
 	{
 		if (strlen(mode) != 2)
 		{
@@ -96,6 +115,22 @@ FileImpl::FileImpl(const string& path_, const char* mode, string& openError)
 	}
 }
 
+void FileImpl::openMapped(string& openError)
+{
+	// read rather than mapped, an update may truncate the file meanwhile
+	string error;
+	contents.reset(new MappedFile(path, MappedFile::Access::Read, &error));
+	if (!error.empty())
+	{
+		openError = error;
+		return;
+	}
+	isMapped = true;
+	mapBegin = contents->data();
+	mapEnd = mapBegin + contents->size();
+	position = mapBegin;
+}
+
 FileImpl::~FileImpl()
 {
 	if (handle)
@@ -125,7 +160,7 @@ FileImpl::~FileImpl()
 
 void FileImpl::assertFileOpened() const
 {
-	if (!handle)
+	if (!handle && !isMapped)
 	{
 		// file was not properly opened
 		fatal2i("file '%s' was not properly opened", path);
@@ -153,6 +188,25 @@ size_t FileImpl::getLineImpl()
 	}
 }
 
+// mimics ::getline on the contents: the line includes the newline character,
+// hitting the end of the contents sets the end-of-file flag
+void FileImpl::getMappedLine(const char*& buffer, size_t& size)
+{
+	buffer = position;
+	auto newLinePosition = (position != mapEnd) ?
+			static_cast< const char* >(memchr(position, '\n', mapEnd - position)) : NULL;
+	if (newLinePosition)
+	{
+		position = newLinePosition + 1;
+	}
+	else
+	{
+		position = mapEnd;
+		mapEof = true;
+	}
+	size = position - buffer;
+}
+
 }
 
 File::File(const string& path, const char* mode, string& openError)
@@ -167,19 +221,28 @@ File::~File()
 File& File::getLine(string& line)
 {
 	__impl->assertFileOpened();
-	auto size = __impl->getLineImpl();
-	if (size > 0 && __impl->buf[size-1] == '\n')
+	const char* buffer;
+	size_t size;
+	rawGetLine(buffer, size);
+	if (size > 0 && buffer[size-1] == '\n')
 	{
 		--size;
 	}
-	line.assign(__impl->buf, size);
+	line.assign(buffer, size);
 	return *this;
 }
 
 File& File::rawGetLine(const char*& buffer, size_t& size)
 {
-	size = __impl->getLineImpl();
-	buffer = __impl->buf;
+	if (__impl->isMapped)
+	{
+		__impl->getMappedLine(buffer, size);
+	}
+	else
+	{
+		size = __impl->getLineImpl();
+		buffer = __impl->buf;
+	}
 	return *this;
 }
 
@@ -187,6 +250,19 @@ File& File::getBlock(char* buffer, size_t& size)
 {
 	__impl->assertFileOpened();
 
+	if (__impl->isMapped)
+	{
+		size_t available = __impl->mapEnd - __impl->position;
+		if (size >= available)
+		{
+			size = available;
+			__impl->mapEof = true;
+		}
+		memcpy(buffer, __impl->position, size);
+		__impl->position += size;
+		return *this;
+	}
+
 	size = ::fread(buffer, 1, size, __impl->handle);
 	if (!size)
 	{
@@ -204,6 +280,15 @@ File& File::getRecord(string& record)
 {
 	__impl->assertFileOpened();
 
+	if (__impl->isMapped)
+	{
+		const char* buffer;
+		size_t size;
+		rawGetRecord(buffer, size);
+		record.assign(buffer, size);
+		return *this;
+	}
+
 	record.clear();
 
 	int readLength;
@@ -220,10 +305,50 @@ File& File::getRecord(string& record)
 	return *this;
 }
 
+File& File::rawGetRecord(const char*& buffer, size_t& size)
+{
+	__impl->assertFileOpened();
+
+	if (__impl->isMapped)
+	{
+		// lines of the record are adjacent in the contents, so the record is
+		// just a range from its first line up to the end-of-record line
+		buffer = __impl->position;
+		const char* lineBuffer;
+		size_t lineSize;
+		const char* recordEnd;
+		do
+		{
+			recordEnd = __impl->position;
+			__impl->getMappedLine(lineBuffer, lineSize);
+		} while (lineSize > 1);
+		size = recordEnd - buffer;
+		if (size)
+		{
+			__impl->mapEof = false;
+		}
+	}
+	else
+	{
+		getRecord(__impl->recordBuffer);
+		buffer = __impl->recordBuffer.data();
+		size = __impl->recordBuffer.size();
+	}
+	return *this;
+}
+
 void File::getFile(string& block)
 {
 	__impl->assertFileOpened();
 
+	if (__impl->isMapped)
+	{
+		block.assign(__impl->position, __impl->mapEnd);
+		__impl->position = __impl->mapEnd;
+		__impl->mapEof = true;
+		return;
+	}
+
 	block.clear();
 
 	int readLength;
@@ -237,12 +362,30 @@ void File::getFile(string& block)
 bool File::eof() const
 {
 	__impl->assertFileOpened();
+	if (__impl->isMapped)
+	{
+		return __impl->mapEof;
+	}
 	return feof(__impl->handle);
 }
 
+bool File::isMapped() const
+{
+	return __impl->isMapped;
+}
+
 void File::seek(size_t newPosition)
 {
-	if (__impl->isPipe)
+	if (__impl->isMapped)
+	{
+		if (newPosition > size_t(__impl->mapEnd - __impl->mapBegin))
+		{
+			fatal2(__("unable to seek on the file '%s'"), __impl->path);
+		}
+		__impl->position = __impl->mapBegin + newPosition;
+		__impl->mapEof = false;
+	}
+	else if (__impl->isPipe)
 	{
 		fatal2(__("an attempt to seek on the pipe '%s'"), __impl->path);
 	}
@@ -257,7 +400,11 @@ void File::seek(size_t newPosition)
 
 size_t File::tell() const
 {
-	if (__impl->isPipe)
+	if (__impl->isMapped)
+	{
+		return __impl->position - __impl->mapBegin;
+	}
+	else if (__impl->isPipe)
 	{
 		fatal2(__("an attempt to tell a position on the pipe '%s'"), __impl->path);
 	}
@@ -279,6 +426,10 @@ size_t File::tell() const
 void File::lock(int flags)
 {
 	__impl->assertFileOpened();
+	if (__impl->isMapped)
+	{
+		fatal2i("an attempt to lock the in-memory file '%s'", __impl->path);
+	}
 	int fd = __guarded_fileno(__impl->handle, __impl->path);
 	// TODO/API break/: provide only lock(void) and unlock(void) methods, consider using fcntl
 	if (flock(fd, flags) == -1)
@@ -291,6 +442,10 @@ void File::lock(int flags)
 void File::put(const char* data, size_t size)
 {
 	__impl->assertFileOpened();
+	if (__impl->isMapped)
+	{
+		fatal2i("an attempt to write to the read-only in-memory file '%s'", __impl->path);
+	}
 	if (fwrite(data, size, 1, __impl->handle) != 1)
 	{
 		fatal2e(__("unable to write to the file '%s'"), __impl->path);
@@ -304,6 +459,10 @@ void File::put(const string& bytes)
 
 void File::unbufferedPut(const char* data, size_t size)
 {
+	if (__impl->isMapped)
+	{
+		fatal2i("an attempt to write to the read-only in-memory file '%s'", __impl->path);
+	}
 	fflush(__impl->handle);
 	int fd = __guarded_fileno(__impl->handle, __impl->path);
 
@@ -0,0 +1,274 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#include <cstring>
+#include <algorithm>
+#include <thread>
+
+#include <internal/arena.hpp>
+
+namespace cupt {
+namespace internal {
+namespace arena {
+
+namespace {
+
+const size_t granularity = 16;
+const size_t maxChunkSize = 1024;
+const size_t blockSize = 64 * 1024;
+
+std::atomic< size_t > nextArenaSerial(1);
+
+// only the owning thread changes the counter, others just read it
+inline void incrementOwnCounter(std::atomic< size_t >& counter)
+{
+	counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+// a chunk is never empty, a deallocated one keeps a free list link
+inline size_t getChunkSize(size_t size)
+{
+	return std::max((size + granularity - 1) / granularity, size_t(1)) * granularity;
+}
+
+}
+
+// the part of an arena used by one thread
+struct ThreadCache
+{
+	const std::thread::id threadId;
+	char* blockPosition;
+	char* blockEnd;
+	// deallocated chunks, linked through their first bytes
+	void* freeLists[maxChunkSize / granularity + 1];
+	std::atomic< size_t > allocationCount;
+	std::atomic< size_t > deallocationCount;
+	size_t reuseCount;
+	size_t oversizedCount;
+	ssize_t liveBytes; // negative if other threads allocated what this thread deallocated
+
+	explicit ThreadCache(std::thread::id threadId_)
+		: threadId(threadId_), blockPosition(NULL), blockEnd(NULL),
+		allocationCount(0), deallocationCount(0), reuseCount(0), oversizedCount(0), liveBytes(0)
+	{
+		memset(freeLists, 0, sizeof(freeLists));
+	}
+};
+
+namespace {
+
+// thread caches used last by this thread, looked up by arena serials
+struct ThreadCacheSlot
+{
+	size_t arenaSerial;
+	ThreadCache* threadCache;
+};
+const size_t threadCacheSlotCount = 4;
+__thread ThreadCacheSlot threadCacheSlots[threadCacheSlotCount];
+
+}
+
+Arena::Arena()
+	: __serial(nextArenaSerial++), __released(false), __destroying(false)
+{}
+
+Arena::~Arena()
+{
+	FORIT(threadCacheIt, __thread_caches)
+	{
+		delete *threadCacheIt;
+	}
+	FORIT(blockIt, __blocks)
+	{
+		delete [] *blockIt;
+	}
+}
+
+ThreadCache& Arena::__get_thread_cache()
+{
+	auto& slot = threadCacheSlots[__serial % threadCacheSlotCount];
+	if (slot.arenaSerial != __serial)
+	{
+		std::lock_guard< std::mutex > lock(__mutex);
+		slot.threadCache = &__find_thread_cache();
+		slot.arenaSerial = __serial;
+	}
+	return *slot.threadCache;
+}
+
+ThreadCache& Arena::__find_thread_cache()
+{
+	auto threadId = std::this_thread::get_id();
+	FORIT(threadCacheIt, __thread_caches)
+	{
+		if ((*threadCacheIt)->threadId == threadId)
+		{
+			return **threadCacheIt;
+		}
+	}
+	__thread_caches.push_back(new ThreadCache(threadId));
+	return *__thread_caches.back();
+}
+
+char* Arena::__get_new_block()
+{
+	__blocks.push_back(new char[blockSize]);
+	return __blocks.back();
+}
+
+ssize_t Arena::__get_live_chunk_count() const
+{
+	ssize_t result = 0;
+	FORIT(threadCacheIt, __thread_caches)
+	{
+		result += (*threadCacheIt)->allocationCount.load(std::memory_order_acquire);
+		result -= (*threadCacheIt)->deallocationCount.load(std::memory_order_acquire);
+	}
+	return result;
+}
+
+void* Arena::allocate(size_t size)
+{
+	auto& threadCache = __get_thread_cache();
+
+	void* result;
+	if (size > maxChunkSize)
+	{
+		result = ::operator new(size);
+		++threadCache.oversizedCount;
+		threadCache.liveBytes += size;
+	}
+	else
+	{
+		size_t chunkSize = getChunkSize(size);
+		void*& freeList = threadCache.freeLists[chunkSize / granularity];
+		if (freeList)
+		{
+			result = freeList;
+			freeList = *static_cast< void** >(result);
+			++threadCache.reuseCount;
+		}
+		else
+		{
+			if (size_t(threadCache.blockEnd - threadCache.blockPosition) < chunkSize)
+			{
+				// the rest of the current block is abandoned, it's never
+				// bigger than the maximum chunk size
+				std::lock_guard< std::mutex > lock(__mutex);
+				threadCache.blockPosition = __get_new_block();
+				threadCache.blockEnd = threadCache.blockPosition + blockSize;
+			}
+			result = threadCache.blockPosition;
+			threadCache.blockPosition += chunkSize;
+		}
+		threadCache.liveBytes += chunkSize;
+	}
+	incrementOwnCounter(threadCache.allocationCount);
+	return result;
+}
+
+void Arena::__deallocate(ThreadCache& threadCache, void* chunk, size_t size)
+{
+	if (size > maxChunkSize)
+	{
+		::operator delete(chunk);
+		threadCache.liveBytes -= size;
+	}
+	else
+	{
+		size_t chunkSize = getChunkSize(size);
+		void*& freeList = threadCache.freeLists[chunkSize / granularity];
+		*static_cast< void** >(chunk) = freeList;
+		freeList = chunk;
+		threadCache.liveBytes -= chunkSize;
+	}
+	// must be the last access to the arena: once the owner sees that
+	// nothing is in use, it destroys the arena
+	incrementOwnCounter(threadCache.deallocationCount);
+}
+
+void Arena::deallocate(void* chunk, size_t size)
+{
+	if (__released.load(std::memory_order_acquire))
+	{
+		__deallocate_after_release(chunk, size);
+	}
+	else
+	{
+		// if the owner releases the arena in the meantime, the arena
+		// sees this chunk as used and is not destroyed at all, which is
+		// only a leak
+		__deallocate(__get_thread_cache(), chunk, size);
+	}
+}
+
+void Arena::__deallocate_after_release(void* chunk, size_t size)
+{
+	bool isLastChunk;
+	{
+		std::lock_guard< std::mutex > lock(__mutex);
+		__deallocate(__find_thread_cache(), chunk, size);
+		isLastChunk = !__destroying && __get_live_chunk_count() == 0;
+		__destroying = __destroying || isLastChunk;
+	}
+	if (isLastChunk)
+	{
+		delete this;
+	}
+}
+
+void Arena::release()
+{
+	bool isUnused;
+	{
+		std::lock_guard< std::mutex > lock(__mutex);
+		__released.store(true, std::memory_order_release);
+		isUnused = (__get_live_chunk_count() == 0);
+		__destroying = isUnused;
+	}
+	if (isUnused)
+	{
+		delete this;
+	}
+}
+
+Arena::Statistics Arena::getStatistics()
+{
+	std::lock_guard< std::mutex > lock(__mutex);
+
+	Statistics result;
+	memset(&result, 0, sizeof(result));
+	ssize_t liveBytes = 0;
+	FORIT(threadCacheIt, __thread_caches)
+	{
+		const ThreadCache& threadCache = **threadCacheIt;
+		result.allocationCount += threadCache.allocationCount.load(std::memory_order_acquire);
+		result.deallocationCount += threadCache.deallocationCount.load(std::memory_order_acquire);
+		result.reuseCount += threadCache.reuseCount;
+		result.oversizedCount += threadCache.oversizedCount;
+		liveBytes += threadCache.liveBytes;
+	}
+	result.liveBytes = liveBytes;
+	result.blockCount = __blocks.size();
+	result.blockBytes = __blocks.size() * blockSize;
+	return result;
+}
+
+}
+}
+}
+
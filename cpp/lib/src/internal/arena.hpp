@@ -0,0 +1,179 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#ifndef CUPT_INTERNAL_ARENA_SEEN
+#define CUPT_INTERNAL_ARENA_SEEN
+
+#include <atomic>
+#include <mutex>
+#include <memory>
+
+#include <cupt/common.hpp>
+
+namespace cupt {
+namespace internal {
+
+// a memory arena owned by a cache; serves small objects (versions, packages
+// and the reference counters of their shared pointers) from big blocks which
+// are released in bulk when the arena is destroyed
+//
+// every thread allocates from its own part of the current block and keeps
+// its own per-size free lists, deallocated chunks are reused because versions
+// are reparsed on each request unless they are memoized; the arena lock is
+// taken only to get a new block or to register a new thread
+//
+// the arena is not destroyed by its owner but released: if some objects
+// allocated from it are still used at this moment, the deallocation of the
+// last of them destroys the arena
+namespace arena {
+
+struct ThreadCache;
+
+class Arena
+{
+ public:
+	struct Statistics
+	{
+		size_t allocationCount;
+		size_t reuseCount; // allocations served from the free lists
+		size_t deallocationCount;
+		size_t oversizedCount; // allocations passed to the global allocator
+		size_t blockCount;
+		size_t blockBytes;
+		size_t liveBytes;
+	};
+ private:
+	const size_t __serial; // distinguishes arenas in per-thread lookup tables
+	std::mutex __mutex; // for the fields below
+	vector< char* > __blocks;
+	vector< ThreadCache* > __thread_caches;
+	std::atomic< bool > __released;
+	bool __destroying;
+
+	ThreadCache& __get_thread_cache();
+	ThreadCache& __find_thread_cache(); // under the lock
+	char* __get_new_block(); // under the lock
+	ssize_t __get_live_chunk_count() const; // under the lock
+	void __deallocate(ThreadCache&, void* chunk, size_t size);
+	void __deallocate_after_release(void* chunk, size_t size);
+
+	Arena(const Arena&);
+	Arena& operator=(const Arena&);
+	~Arena();
+ public:
+	Arena();
+	void* allocate(size_t size);
+	void deallocate(void* chunk, size_t size);
+	// exact only when no other thread uses the arena at the moment
+	Statistics getStatistics();
+	// the owner won't allocate anything from the arena anymore
+	void release();
+};
+
+// owns an arena, releases it when destroyed
+struct Releaser
+{
+	void operator()(Arena* arena) const
+	{
+		arena->release();
+	}
+};
+typedef std::unique_ptr< Arena, Releaser > ArenaPtr;
+
+// a standard allocator on top of an arena
+template < typename T >
+class Allocator
+{
+	template < typename U > friend class Allocator;
+
+	Arena* __arena;
+ public:
+	typedef T value_type;
+	typedef T* pointer;
+	typedef const T* const_pointer;
+	typedef T& reference;
+	typedef const T& const_reference;
+	typedef size_t size_type;
+	typedef ptrdiff_t difference_type;
+	template < typename U > struct rebind { typedef Allocator< U > other; };
+
+	explicit Allocator(Arena* arena)
+		: __arena(arena)
+	{}
+	template < typename U >
+	Allocator(const Allocator< U >& other)
+		: __arena(other.__arena)
+	{}
+
+	T* allocate(size_t count, const void* = NULL)
+	{
+		return static_cast< T* >(__arena->allocate(count * sizeof(T)));
+	}
+	void deallocate(T* pointer, size_t count)
+	{
+		__arena->deallocate(pointer, count * sizeof(T));
+	}
+	size_t max_size() const
+	{
+		return size_t(-1) / sizeof(T);
+	}
+	T* address(T& object) const { return &object; }
+	const T* address(const T& object) const { return &object; }
+	template < typename U, typename... Args >
+	void construct(U* pointer, Args&&... args)
+	{
+		new (pointer) U(std::forward< Args >(args)...);
+	}
+	template < typename U >
+	void destroy(U* pointer)
+	{
+		pointer->~U();
+	}
+
+	template < typename U >
+	bool operator==(const Allocator< U >& other) const
+	{
+		return __arena == other.__arena;
+	}
+	template < typename U >
+	bool operator!=(const Allocator< U >& other) const
+	{
+		return __arena != other.__arena;
+	}
+};
+
+// allocates an object in the arena, or in the free store if there is no arena
+template < typename T, typename... Args >
+shared_ptr< T > makeShared(Arena* arena, Args&&... args)
+{
+	if (arena)
+	{
+		return std::allocate_shared< T >(Allocator< T >(arena), std::forward< Args >(args)...);
+	}
+	else
+	{
+		return std::make_shared< T >(std::forward< Args >(args)...);
+	}
+}
+
+}
+
+}
+}
+
+#endif
+
@@ -385,6 +385,16 @@ string getPathOfExtendedStates(const Config& config)
 	return config.getPath("dir::state::extendedstates");
 }
 
+string getPathOfDpkgStatusSnapshot(const Config& config)
+{
+	return config.getPath("dir::cache") + "/dpkg-status.snapshot";
+}
+
+string getPathOfListsLock(const Config& config)
+{
+	return config.getPath("cupt::directory::state::lists") + "/lock";
+}
+
 bool verifySignature(const Config& config, const string& path, const string& alias)
 {
 	auto debugging = config.getBool("debug::gpgv");
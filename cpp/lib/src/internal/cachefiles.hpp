@@ -31,6 +31,8 @@ typedef Cache::IndexDownloadRecord FileDownloadRecord;
 string getPathOfIndexList(const Config&, const IndexEntry&);
 string getPathOfReleaseList(const Config&, const IndexEntry&);
 string getPathOfExtendedStates(const Config&);
+string getPathOfDpkgStatusSnapshot(const Config&);
+string getPathOfListsLock(const Config&);
 
 string getDownloadUriOfReleaseList(const IndexEntry&);
 vector< FileDownloadRecord > getDownloadInfoOfIndexList(
@@ -15,6 +15,9 @@
 *   Free Software Foundation, Inc.,                                       *
 *   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
 **************************************************************************/
+#include <algorithm>
+#include <tuple>
+
 #include <common/regex.hpp>
 
 #include <cupt/config.hpp>
@@ -34,25 +37,73 @@
 #include <internal/regex.hpp>
 #include <internal/common.hpp>
 #include <internal/cachefiles.hpp>
+#include <internal/indexofindex.hpp>
+#include <internal/stringpool.hpp>
+#include <internal/arena.hpp>
+#include <internal/translationindex.hpp>
+#include <internal/md5.hpp>
+#include <internal/versionlru.hpp>
+#include <internal/relationparser.hpp>
+#include <internal/threadpool.hpp>
+#include <internal/persistentfile.hpp>
 
 namespace cupt {
 namespace internal {
 
 CacheImpl::CacheImpl()
-	: __smatch_ptr(new smatch)
-{}
+	: arena(new arena::Arena), reverseProvidesIndexIsBuilt(false), reverseDependencyCandidatesAreBuilt(false),
+	getSatisfyingVersionsCacheHitCount(0), getSatisfyingVersionsCacheMissCount(0), __smatch_ptr(new smatch),
+	sourceLoaded(false), binaryLoaded(false), installedLoaded(false),
+	packageContext(new PackageContext), useSource(false), useBinary(false), useInstalled(false)
+{
+	packageContext->arena = arena.get();
+}
 
 CacheImpl::~CacheImpl()
 {
 	delete __smatch_ptr;
+	// packages which outlive the cache parse their versions into the free store
+	packageContext->arena = NULL;
+
+	if (config && config->getBool("debug::cache"))
+	{
+		if (packageContext->versionLru)
+		{
+			auto lruStatistics = packageContext->versionLru->getStatistics();
+			debug2("version memoization: %zu hits, %zu misses, %zu evictions, "
+					"%zu packages (%zu KiB) kept",
+					lruStatistics.hitCount, lruStatistics.missCount, lruStatistics.evictionCount,
+					lruStatistics.entryCount, lruStatistics.bytes / 1024);
+		}
+		debug2("satisfying versions memoization: %zu hits, %zu misses, %zu distinct relation expressions known",
+				getSatisfyingVersionsCacheHitCount, getSatisfyingVersionsCacheMissCount,
+				getSatisfyingVersionsCache.size());
+
+		// packages and memoized versions go away with the cache, what is
+		// left alive is still referenced from outside
+		completeBinaryPackages.clear();
+		binaryPackages.clear();
+		sourcePackages.clear();
+		getSatisfyingVersionsCache.clear();
+		binaryPinCache.clear();
+		sourcePinCache.clear();
+
+		auto statistics = arena->getStatistics();
+		debug2("memory arena: %zu allocations (%zu reused, %zu oversized), %zu deallocations, "
+				"%zu blocks (%zu KiB), %zu bytes still in use",
+				statistics.allocationCount, statistics.reuseCount, statistics.oversizedCount,
+				statistics.deallocationCount, statistics.blockCount, statistics.blockBytes / 1024,
+				statistics.liveBytes);
+	}
 }
 
 void CacheImpl::processProvides(const string* packageNamePtr,
-		const char* providesStringStart, const char* providesStringEnd)
+		const char* providesStringStart, const char* providesStringEnd, bool installed)
 {
-	auto callback = [this, &packageNamePtr](const char* tokenBeginIt, const char* tokenEndIt)
+	auto provider = make_pair(stringpool::intern(*packageNamePtr), installed);
+	auto callback = [this, &provider](const char* tokenBeginIt, const char* tokenEndIt)
 	{
-		this->canProvide[string(tokenBeginIt, tokenEndIt)].insert(packageNamePtr);
+		this->canProvide[stringpool::intern(tokenBeginIt, tokenEndIt - tokenBeginIt)].insert(provider);
 	};
 	processSpaceCommaSpaceDelimitedStrings(
 			providesStringStart, providesStringEnd, callback);
@@ -70,45 +121,154 @@ shared_ptr< Package > CacheImpl::newBinaryPackage(const string& packageName) con
 		}
 	}
 
-	return std::make_shared< BinaryPackage >(binaryArchitecture, needsReinstall);
+	auto result = arena::makeShared< BinaryPackage >(arena.get(), binaryArchitecture, needsReinstall);
+	result->_set_context(packageContext);
+	return result;
 }
 
 shared_ptr< Package > CacheImpl::newSourcePackage(const string& /* packageName */) const
 {
-	return shared_ptr< Package >(new SourcePackage(binaryArchitecture));
+	auto result = arena::makeShared< SourcePackage >(arena.get(), binaryArchitecture);
+	result->_set_context(packageContext);
+	return result;
+}
+
+namespace {
+
+void addPreRecord(Package& package, const string& packageName, const CacheImpl::PrePackageRecord& record)
+{
+	Version::InitializationParameters versionInitParams;
+	versionInitParams.releaseInfo = record.releaseInfoAndFile->first;
+	versionInitParams.file = record.releaseInfoAndFile->second;
+	versionInitParams.offset = record.offset;
+	versionInitParams.packageName = packageName;
+	package.addEntry(versionInitParams);
+}
+
+bool isInstalledRelease(const ReleaseInfo& releaseInfo)
+{
+	// installed versions come from releases without base URI
+	return releaseInfo.baseUri.empty();
+}
+
 }
 
-shared_ptr< Package > CacheImpl::preparePackage(unordered_map< string, vector< PrePackageRecord > >& pre,
-		unordered_map< string, shared_ptr< Package > >& target, const string& packageName,
-		decltype(&CacheImpl::newBinaryPackage) packageBuilderMethod) const
+shared_ptr< Package > CacheImpl::getCompleteBinaryPackage(const string& packageName) const
 {
-	auto preIt = pre.find(packageName);
-	if (preIt != pre.end())
+	auto packageIt = completeBinaryPackages.find(packageName);
+	auto preIt = preBinaryPackages.find(packageName);
+	if (preIt == preBinaryPackages.end())
 	{
-		shared_ptr< Package >& package = target[packageName];
-		if (!package)
+		return packageIt != completeBinaryPackages.end() ? packageIt->second : shared_ptr< Package >();
+	}
+
+	// records of the parts loaded after the package was built are merged in,
+	// the installed version has to be the first one
+	auto package = newBinaryPackage(packageName);
+	const vector< PrePackageRecord >& preRecords = preIt->second;
+	FORIT(preRecordIt, preRecords)
+	{
+		if (isInstalledRelease(*preRecordIt->releaseInfoAndFile->first))
 		{
-			// there was no such package before, and an insertion occured
-			// so, we need to create the package
-			package = (this->*packageBuilderMethod)(packageName);
+			addPreRecord(*package, packageName, *preRecordIt);
 		}
-		vector< PrePackageRecord >& preRecord = preIt->second;
-		FORIT(preRecordIt, preRecord)
+	}
+	if (packageIt != completeBinaryPackages.end())
+	{
+		const auto& entries = packageIt->second->_get_entries();
+		FORIT(entryIt, entries)
 		{
-			Version::InitializationParameters versionInitParams;
-			versionInitParams.releaseInfo = preRecordIt->releaseInfoAndFile->first;
-			versionInitParams.file = preRecordIt->releaseInfoAndFile->second;
-			versionInitParams.offset = preRecordIt->offset;
-			versionInitParams.packageName = packageName;
-			package->addEntry(versionInitParams);
+			package->addEntry(*entryIt);
 		}
-		preRecord.clear();
-		return package;
 	}
-	else
+	FORIT(preRecordIt, preRecords)
 	{
-		return shared_ptr< Package >();
+		if (!isInstalledRelease(*preRecordIt->releaseInfoAndFile->first))
+		{
+			addPreRecord(*package, packageName, *preRecordIt);
+		}
 	}
+
+	preBinaryPackages.erase(preIt);
+	completeBinaryPackages[packageName] = package;
+	return package;
+}
+
+bool CacheImpl::isBinaryReleaseVisible(const ReleaseInfo& releaseInfo) const
+{
+	return isInstalledRelease(releaseInfo) ? useInstalled : useBinary;
+}
+
+bool CacheImpl::areAllBinaryPartsVisible() const
+{
+	return (useBinary || !binaryLoaded) && (useInstalled || !installedLoaded);
+}
+
+vector< string > CacheImpl::getBinaryPackageNames() const
+{
+	bool allVisible = areAllBinaryPartsVisible();
+	auto isPreRecordVisible = [this](const PrePackageRecord& record)
+	{
+		return this->isBinaryReleaseVisible(*record.releaseInfoAndFile->first);
+	};
+	auto hasVisibleEntry = [this](const Package& package)
+	{
+		const auto& entries = package._get_entries();
+		return std::any_of(entries.begin(), entries.end(),
+				[this](const Version::InitializationParameters& entry)
+				{
+					return this->isBinaryReleaseVisible(*entry.releaseInfo);
+				});
+	};
+
+	vector< string > result;
+	FORIT(it, preBinaryPackages)
+	{
+		if (!allVisible)
+		{
+			const vector< PrePackageRecord >& preRecords = it->second;
+			if (std::none_of(preRecords.begin(), preRecords.end(), isPreRecordVisible))
+			{
+				auto packageIt = completeBinaryPackages.find(it->first);
+				if (packageIt == completeBinaryPackages.end() || !hasVisibleEntry(*packageIt->second))
+				{
+					continue;
+				}
+			}
+		}
+		result.push_back(it->first);
+	}
+	FORIT(it, completeBinaryPackages)
+	{
+		if (preBinaryPackages.count(it->first))
+		{
+			continue; // listed above
+		}
+		if (!allVisible && !hasVisibleEntry(*it->second))
+		{
+			continue;
+		}
+		result.push_back(it->first);
+	}
+	return result;
+}
+
+vector< string > CacheImpl::getSourcePackageNames() const
+{
+	vector< string > result;
+	if (!useSource)
+	{
+		return result;
+	}
+	FORIT(it, preSourcePackages)
+	{
+		result.push_back(it->first);
+	}
+	FORIT(it, sourcePackages)
+	{
+		result.push_back(it->first);
+	}
+	return result;
 }
 
 vector< shared_ptr< const BinaryVersion > >
@@ -123,17 +283,17 @@ CacheImpl::getSatisfyingVersions(const Relation& relation) const
 	if (package)
 	{
 		// if such binary package exists
-		auto versions = package->getVersions();
-		FORIT(it, versions)
+		auto versions = package->getVersionRange();
+		for (auto it = versions.begin(); it != versions.end(); ++it)
 		{
-			if (relation.isSatisfiedBy((*it)->versionString))
+			if (relation.isSatisfiedBy(**it))
 			{
-				if ((*it)->isInstalled() &&
-						systemState->getInstalledInfo((*it)->packageName)->isBroken())
+				if (it->isInstalled() &&
+						systemState->getInstalledInfo(it->packageName)->isBroken())
 				{
 					continue;
 				}
-				result.push_back(*it);
+				result.push_back(it.getShared());
 			}
 		}
 	}
@@ -141,39 +301,343 @@ CacheImpl::getSatisfyingVersions(const Relation& relation) const
 	// virtual package can only be considered if no relation sign is specified
 	if (relation.relationType == Relation::Types::None)
 	{
+		if (!reverseProvidesIndexIsBuilt)
+		{
+			buildReverseProvidesIndex();
+		}
+
 		// looking for reverse-provides
-		auto reverseProvidesIt = canProvide.find(packageName);
-		if (reverseProvidesIt != canProvide.end())
+		auto indexIt = reverseProvidesIndex.find(stringpool::find(packageName));
+		if (indexIt != reverseProvidesIndex.end())
 		{
-			const set< const string* >& reverseProvides = reverseProvidesIt->second;
-			FORIT(it, reverseProvides)
+			for (auto i = indexIt->second.first; i != indexIt->second.second; ++i)
 			{
-				auto reverseProvidePackage = getBinaryPackage(**it);
-				if (!reverseProvidePackage)
+				const auto& version = reverseProvideRecords[i].version;
+				if (version->isInstalled() &&
+						systemState->getInstalledInfo(version->packageName)->isBroken())
 				{
 					continue;
 				}
-				auto versions = reverseProvidePackage->getVersions();
-				FORIT(versionIt, versions)
+				result.push_back(version);
+			}
+		}
+	}
+
+	return result;
+}
+
+void CacheImpl::buildReverseProvidesIndex() const
+{
+	struct Entry
+	{
+		const string* virtualPackageName;
+		ReverseProvideRecord record;
+
+		bool operator<(const Entry& other) const
+		{
+			return virtualPackageName < other.virtualPackageName;
+		}
+		bool operator==(const Entry& other) const
+		{
+			return virtualPackageName == other.virtualPackageName && record.version == other.record.version;
+		}
+	};
+	vector< Entry > entries;
+
+	// providers from the hidden parts only are not looked at
+	set< const string* > providers;
+	FORIT(it, canProvide)
+	{
+		FORIT(providerIt, it->second)
+		{
+			if (providerIt->second ? useInstalled : useBinary)
+			{
+				providers.insert(providerIt->first);
+			}
+		}
+	}
+	// each package is parsed once, not once per every virtual package it provides
+	FORIT(providerIt, providers)
+	{
+		auto package = getBinaryPackage(**providerIt);
+		if (!package)
+		{
+			continue;
+		}
+		auto versions = package->getVersionRange();
+		for (auto versionIt = versions.begin(); versionIt != versions.end(); ++versionIt)
+		{
+			const vector< string >& provides = versionIt->provides.get();
+			FORIT(providesIt, provides)
+			{
+				Entry entry = { stringpool::intern(*providesIt), { versionIt.getShared() } };
+				entries.push_back(entry);
+			}
+		}
+	}
+	// providers keep their order; a version providing the same name twice
+	// has adjacent entries then, and is listed once
+	std::stable_sort(entries.begin(), entries.end());
+	entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+
+	reverseProvidesIndex.clear();
+	reverseProvideRecords.clear();
+	reverseProvideRecords.reserve(entries.size());
+	FORIT(entryIt, entries)
+	{
+		auto& range = reverseProvidesIndex.insert({ entryIt->virtualPackageName,
+				{ uint32_t(reverseProvideRecords.size()), 0 } }).first->second;
+		reverseProvideRecords.push_back(entryIt->record);
+		range.second = reverseProvideRecords.size();
+	}
+
+	reverseProvidesIndexIsBuilt = true;
+}
+
+void CacheImpl::buildReverseDependencyCandidates() const
+{
+	typedef BinaryVersion::RelationTypes RelationTypes;
+
+	// getting versions is not thread-safe, so all of them are got beforehand;
+	// after that only distinct versions are parsed concurrently
+	struct PackageVersions
+	{
+		const string* packageName;
+		VersionRange< BinaryVersion > versions;
+	};
+	vector< PackageVersions > packages;
+	{
+		auto packageNames = getBinaryPackageNames();
+		packages.reserve(packageNames.size());
+		FORIT(packageNameIt, packageNames)
+		{
+			auto package = getBinaryPackage(*packageNameIt);
+			if (package)
+			{
+				PackageVersions packageVersions = { stringpool::intern(*packageNameIt), package->getVersionRange() };
+				packages.push_back(std::move(packageVersions));
+			}
+		}
+	}
+
+	// packages are handed out in chunks, and every chunk interns the names
+	// through its own cache, so workers rarely touch the shared string pool
+	const size_t chunkSize = 256;
+	vector< vector< ReverseDependencyCandidate > > candidatesByChunk((packages.size() + chunkSize - 1) / chunkSize);
+	auto processChunk = [&packages, &candidatesByChunk, chunkSize](size_t chunkIndex)
+	{
+		auto& candidates = candidatesByChunk[chunkIndex];
+		relationparser::LocalCache localCache;
+		// relations which are not parsed yet are tokenized right in the
+		// index file instead of building relation lines which are not needed
+		vector< relationparser::Record > records;
+		size_t packagesEnd = std::min(packages.size(), (chunkIndex + 1) * chunkSize);
+		for (size_t packageIndex = chunkIndex * chunkSize; packageIndex < packagesEnd; ++packageIndex)
+		{
+			const PackageVersions& package = packages[packageIndex];
+			for (size_t versionIndex = 0; versionIndex < package.versions.size(); ++versionIndex)
+			{
+				const auto& version = package.versions[versionIndex];
+				for (size_t relationType = 0; relationType < RelationTypes::Count; ++relationType)
 				{
-					if ((*versionIt)->isInstalled() &&
-							systemState->getInstalledInfo((*versionIt)->packageName)->isBroken())
+					records.clear();
+					const auto& relationLine = version->relations[relationType];
+					const char* rawBegin;
+					const char* rawEnd;
+					if (relationLine.getRaw(rawBegin, rawEnd))
+					{
+						relationparser::parseLine(rawBegin, rawEnd, records, localCache);
+					}
+					else
 					{
-						continue;
+						relationparser::convertLine(relationLine.get(), records);
 					}
-					const vector< string >& realProvides = (*versionIt)->provides;
-					FORIT(realProvidesIt, realProvides)
+
+					uint32_t expressionIndex = 0;
+					FORIT(recordIt, records)
 					{
-						if (*realProvidesIt == packageName)
+						ReverseDependencyCandidate candidate = { *recordIt, package.packageName,
+								uint32_t(versionIndex), uint32_t(relationType), expressionIndex };
+						candidates.push_back(candidate);
+						if (recordIt->isLastAlternative)
 						{
-							// ok, this particular version does provide this virtual package
-							result.push_back(*versionIt);
-							break;
+							++expressionIndex;
 						}
 					}
 				}
 			}
 		}
+	};
+	threadpool::ThreadPool::runOnce(candidatesByChunk.size(),
+			config->getInteger("cupt::cache::reverse-dependency-index-threads"), processChunk);
+
+	size_t candidateCount = 0;
+	FORIT(chunkCandidatesIt, candidatesByChunk)
+	{
+		candidateCount += chunkCandidatesIt->size();
+	}
+	vector< ReverseDependencyCandidate > candidates;
+	candidates.reserve(candidateCount);
+	FORIT(chunkCandidatesIt, candidatesByChunk)
+	{
+		candidates.insert(candidates.end(), chunkCandidatesIt->begin(), chunkCandidatesIt->end());
+		vector< ReverseDependencyCandidate >().swap(*chunkCandidatesIt);
+	}
+	// candidates referring to the same name become adjacent, keeping their order
+	std::stable_sort(candidates.begin(), candidates.end(),
+			[](const ReverseDependencyCandidate& left, const ReverseDependencyCandidate& right)
+			{
+				return left.relation.packageName < right.relation.packageName;
+			});
+
+	reverseDependencyCandidateIndex.clear();
+	for (size_t i = 0; i < candidates.size(); ++i)
+	{
+		auto& range = reverseDependencyCandidateIndex.insert({ candidates[i].relation.packageName,
+				{ uint32_t(i), 0 } }).first->second;
+		range.second = i + 1;
+	}
+	reverseDependencyCandidates.swap(candidates);
+
+	reverseDependencyCandidatesAreBuilt = true;
+}
+
+const vector< CacheImpl::ReverseDependencyRecord >& CacheImpl::getReverseDependencyRecords(
+		const string* packageName, const VersionRange< BinaryVersion >& versions) const
+{
+	if (!reverseDependencyCandidatesAreBuilt)
+	{
+		buildReverseDependencyCandidates();
+	}
+
+	auto insertResult = reverseDependencyRecords.insert({ packageName, {} });
+	auto& result = insertResult.first->second;
+	if (!insertResult.second)
+	{
+		return result;
+	}
+
+	auto forEachCandidate = [this](const string* referredPackageName,
+			const std::function< void (const ReverseDependencyCandidate&) >& callback)
+	{
+		auto indexIt = reverseDependencyCandidateIndex.find(referredPackageName);
+		if (indexIt != reverseDependencyCandidateIndex.end())
+		{
+			for (auto i = indexIt->second.first; i != indexIt->second.second; ++i)
+			{
+				callback(reverseDependencyCandidates[i]);
+			}
+		}
+	};
+	for (size_t targetVersionIndex = 0; targetVersionIndex < versions.size(); ++targetVersionIndex)
+	{
+		auto addRecord = [&result, targetVersionIndex](const ReverseDependencyCandidate& candidate)
+		{
+			ReverseDependencyRecord record = { uint32_t(targetVersionIndex), candidate.relationType,
+					candidate.packageName, candidate.versionIndex, candidate.relationExpressionIndex };
+			result.push_back(record);
+		};
+
+		// mirrors getSatisfyingVersions(const Relation&)
+		const BinaryVersion& version = *versions[targetVersionIndex];
+		if (version.isInstalled() && systemState->getInstalledInfo(version.packageName)->isBroken())
+		{
+			continue;
+		}
+		forEachCandidate(packageName, [&version, &addRecord](const ReverseDependencyCandidate& candidate)
+		{
+			if (relationparser::isSatisfiedBy(candidate.relation, version))
+			{
+				addRecord(candidate);
+			}
+		});
+		const vector< string >& provides = version.provides.get();
+		FORIT(providesIt, provides)
+		{
+			forEachCandidate(stringpool::find(*providesIt), [&addRecord](const ReverseDependencyCandidate& candidate)
+			{
+				if (candidate.relation.relationType == Relation::Types::None)
+				{
+					addRecord(candidate);
+				}
+			});
+		}
+	}
+
+	auto key = [](const ReverseDependencyRecord& record)
+	{
+		return std::tie(record.targetVersionIndex, record.relationType,
+				*record.packageName, record.versionIndex, record.relationExpressionIndex);
+	};
+	std::sort(result.begin(), result.end(),
+			[&key](const ReverseDependencyRecord& left, const ReverseDependencyRecord& right)
+			{
+				return key(left) < key(right);
+			});
+	// alternatives of one relation expression may be satisfied by the same
+	// version, and a version may provide the same name twice
+	result.erase(std::unique(result.begin(), result.end(),
+			[&key](const ReverseDependencyRecord& left, const ReverseDependencyRecord& right)
+			{
+				return key(left) == key(right);
+			}), result.end());
+	result.shrink_to_fit();
+
+	return result;
+}
+
+vector< Cache::ReverseDependency > CacheImpl::getReverseDependencies(
+		const shared_ptr< const BinaryVersion >& version, BinaryVersion::RelationTypes::Type relationType) const
+{
+	vector< Cache::ReverseDependency > result;
+
+	auto package = getBinaryPackage(version->packageName);
+	if (!package)
+	{
+		return result;
+	}
+	auto versions = package->getVersionRange();
+	uint32_t targetVersionIndex = 0;
+	while (targetVersionIndex < versions.size() &&
+			versions[targetVersionIndex]->versionString != version->versionString)
+	{
+		++targetVersionIndex;
+	}
+	if (targetVersionIndex == versions.size())
+	{
+		return result;
+	}
+
+	const auto& records = getReverseDependencyRecords(stringpool::intern(version->packageName), versions);
+
+	// records are sorted by target version index and relation type first
+	struct Less
+	{
+		bool operator()(const ReverseDependencyRecord& left, const ReverseDependencyRecord& right) const
+		{
+			return std::make_pair(left.targetVersionIndex, left.relationType) <
+					std::make_pair(right.targetVersionIndex, right.relationType);
+		}
+	};
+	ReverseDependencyRecord key;
+	key.targetVersionIndex = targetVersionIndex;
+	key.relationType = relationType;
+	auto range = std::equal_range(records.begin(), records.end(), key, Less());
+
+	const string* lastPackageName = NULL;
+	VersionRange< BinaryVersion > dependingVersions;
+	for (auto recordIt = range.first; recordIt != range.second; ++recordIt)
+	{
+		if (recordIt->packageName != lastPackageName)
+		{
+			// records of the same package are adjacent
+			dependingVersions = getBinaryPackage(*recordIt->packageName)->getVersionRange();
+			lastPackageName = recordIt->packageName;
+		}
+		auto dependingVersion = dependingVersions[recordIt->versionIndex];
+		Cache::ReverseDependency reverseDependency = { dependingVersions.getShared(recordIt->versionIndex),
+				&dependingVersion->relations[relationType].get()[recordIt->relationExpressionIndex] };
+		result.push_back(reverseDependency);
 	}
 
 	return result;
@@ -182,33 +646,66 @@ CacheImpl::getSatisfyingVersions(const Relation& relation) const
 shared_ptr< const BinaryPackage > CacheImpl::getBinaryPackage(const string& packageName) const
 {
 	auto it = binaryPackages.find(packageName);
-	if (it == binaryPackages.end())
+	if (it != binaryPackages.end())
 	{
-		auto prepareResult = preparePackage(preBinaryPackages,
-				binaryPackages, packageName, &CacheImpl::newBinaryPackage);
-		// can be empty/NULL also
-		return static_pointer_cast< const BinaryPackage >(prepareResult);
+		return static_pointer_cast< const BinaryPackage >(it->second);
 	}
-	else
+
+	auto package = getCompleteBinaryPackage(packageName);
+	if (package && !areAllBinaryPartsVisible())
 	{
-		return static_pointer_cast< const BinaryPackage >(it->second);
+		// the complete package is kept, so the package can be rebuilt if the
+		// set of visible cache parts changes
+		shared_ptr< Package > visiblePackage;
+		const auto& entries = package->_get_entries();
+		FORIT(entryIt, entries)
+		{
+			if (isBinaryReleaseVisible(*entryIt->releaseInfo))
+			{
+				if (!visiblePackage)
+				{
+					visiblePackage = newBinaryPackage(packageName);
+				}
+				visiblePackage->addEntry(*entryIt);
+			}
+		}
+		package = visiblePackage;
+	}
+	if (package)
+	{
+		binaryPackages[packageName] = package;
 	}
+	// can be empty/NULL also
+	return static_pointer_cast< const BinaryPackage >(package);
 }
 
 shared_ptr< const SourcePackage > CacheImpl::getSourcePackage(const string& packageName) const
 {
-	auto it = sourcePackages.find(packageName);
-	if (it == sourcePackages.end())
+	if (!useSource)
 	{
-		auto prepareResult = preparePackage(preSourcePackages,
-				sourcePackages, packageName, &CacheImpl::newSourcePackage);
-		// can be empty/NULL also
-		return static_pointer_cast< const SourcePackage >(prepareResult);
+		return shared_ptr< const SourcePackage >();
 	}
-	else
+
+	auto it = sourcePackages.find(packageName);
+	if (it != sourcePackages.end())
 	{
 		return static_pointer_cast< const SourcePackage >(it->second);
 	}
+
+	shared_ptr< Package > package;
+	auto preIt = preSourcePackages.find(packageName);
+	if (preIt != preSourcePackages.end())
+	{
+		package = newSourcePackage(packageName);
+		FORIT(preRecordIt, preIt->second)
+		{
+			addPreRecord(*package, packageName, *preRecordIt);
+		}
+		sourcePackages[packageName] = package;
+		preSourcePackages.erase(preIt);
+	}
+	// can be empty/NULL also
+	return static_pointer_cast< const SourcePackage >(package);
 }
 
 void CacheImpl::parseSourcesLists()
@@ -422,9 +919,99 @@ class ReleaseLimits
 	}
 };
 
+// results of scanning one index file, filled possibly in a separate thread
+// and merged into the cache afterwards in the order of index entries
+struct CacheImpl::IndexFileScan
+{
+	string path;
+	string alias;
+	IndexEntry::Type category;
+	const pair< shared_ptr< const ReleaseInfo >, shared_ptr< File > >* releaseInfoAndFile;
+
+	vector< pair< string, size_t > > records; // package name, offset
+	vector< pair< size_t, string > > provides; // record number, provides string
+	vector< pair< const char*, string > > messages; // printed by the main thread
+	bool failed; // nothing of the index is merged then
+};
+
+void CacheImpl::load(bool useSource, bool useBinary, bool useInstalled,
+		const vector< string >& packageNameGlobsToReinstall)
+{
+	bool changed = (useSource != this->useSource || useBinary != this->useBinary ||
+			useInstalled != this->useInstalled);
+
+	if (useInstalled && !installedLoaded)
+	{
+		systemState.reset(new system::State(config, this));
+		installedLoaded = true;
+		pinInfo.reset(); // depends on the system state
+	}
+
+	bool loadSource = useSource && !sourceLoaded;
+	bool loadBinary = useBinary && !binaryLoaded;
+	if (loadSource || loadBinary)
+	{
+		processIndexEntries(loadBinary, loadSource);
+		sourceLoaded |= loadSource;
+		binaryLoaded |= loadBinary;
+		pinInfo.reset(); // precomputed for known releases
+	}
+
+	if (!pinInfo)
+	{
+		parsePreferences();
+	}
+
+	if (packageNameGlobsToReinstall != this->packageNameGlobsToReinstall)
+	{
+		setPackageNameGlobsToReinstall(packageNameGlobsToReinstall);
+		changed = true;
+	}
+
+	this->useSource = useSource;
+	this->useBinary = useBinary;
+	this->useInstalled = useInstalled;
+
+	if (changed)
+	{
+		// binary packages are built from the visible parts only; source
+		// packages are either all visible or none
+		binaryPackages.clear();
+		getSatisfyingVersionsCache.clear();
+		binaryPinCache.clear();
+		sourcePinCache.clear();
+		reverseProvidesIndexIsBuilt = false;
+		reverseDependencyCandidatesAreBuilt = false;
+		reverseDependencyRecords.clear();
+	}
+}
+
+void CacheImpl::setPackageNameGlobsToReinstall(const vector< string >& globs)
+{
+	packageNameGlobsToReinstall = globs;
+	packageNameRegexesToReinstall.clear();
+	FORIT(it, globs)
+	{
+		packageNameRegexesToReinstall.push_back(globToRegex(*it));
+	}
+
+	// the reinstall flag is set when a package is created
+	FORIT(it, completeBinaryPackages)
+	{
+		auto package = newBinaryPackage(it->first);
+		const auto& entries = it->second->_get_entries();
+		FORIT(entryIt, entries)
+		{
+			package->addEntry(*entryIt);
+		}
+		it->second = package;
+	}
+}
+
 void CacheImpl::processIndexEntries(bool useBinary, bool useSource)
 {
 	ReleaseLimits releaseLimits(*config);
+	vector< IndexFileScan > scans;
 	FORIT(indexEntryIt, indexEntries)
 	{
 		const IndexEntry& entry = *indexEntryIt;
@@ -438,11 +1025,42 @@ void CacheImpl::processIndexEntries(bool useBinary, bool useSource)
 			continue;
 		}
 
-		processIndexEntry(entry, releaseLimits);
+		processIndexEntry(entry, releaseLimits, scans);
 	}
+
+	scanIndexFiles(scans);
+
+	// merging strictly in the order of index entries, versions of a package
+	// have to come in the same order as their sources do
+	FORIT(scanIt, scans)
+	{
+		FORIT(messageIt, scanIt->messages)
+		{
+			__mwrite_line(messageIt->first, messageIt->second);
+		}
+		try
+		{
+			if (scanIt->failed)
+			{
+				fatal2(__("unable to parse the index '%s'"), scanIt->alias);
+			}
+			mergeIndexFileScan(*scanIt);
+		}
+		catch (Exception&)
+		{
+			warn2(__("skipped the index '%s'"), scanIt->alias);
+		}
+	}
+}
+
+shared_ptr< const ReleaseInfo > CacheImpl::registerRelease(const shared_ptr< ReleaseInfo >& releaseInfo)
+{
+	releaseInfo->id = releases.size();
+	releases.push_back(releaseInfo);
+	return releaseInfo;
 }
 
-shared_ptr< ReleaseInfo > CacheImpl::getReleaseInfo(const Config& config, const IndexEntry& indexEntry)
+shared_ptr< const ReleaseInfo > CacheImpl::getReleaseInfo(const Config& config, const IndexEntry& indexEntry)
 {
 	auto path = cachefiles::getPathOfReleaseList(config, indexEntry);
 	auto insertResult = releaseInfoCache.insert({ path, {} });
@@ -457,11 +1075,21 @@ shared_ptr< ReleaseInfo > CacheImpl::getReleaseInfo(const Config& config, const
 	{
 		throw Exception(""); // !cachedValue means that getReleaseInfo has failed before
 	}
-	return shared_ptr< ReleaseInfo > (new ReleaseInfo(*cachedValue));
+
+	// binary and source indexes of the same component share the record
+	auto& record = releaseInfoRecords[{ path, indexEntry.component }];
+	if (!record)
+	{
+		shared_ptr< ReleaseInfo > releaseInfo(new ReleaseInfo(*cachedValue));
+		releaseInfo->component = indexEntry.component;
+		releaseInfo->baseUri = indexEntry.uri;
+		record = registerRelease(releaseInfo);
+	}
+	return record;
 }
 
 void CacheImpl::processIndexEntry(const IndexEntry& indexEntry,
-		const ReleaseLimits& releaseLimits)
+		const ReleaseLimits& releaseLimits, vector< IndexFileScan >& scans)
 {
 	string indexFileToParse = cachefiles::getPathOfIndexList(*config, indexEntry);
 
@@ -469,12 +1097,10 @@ void CacheImpl::processIndexEntry(const IndexEntry& indexEntry,
 			indexEntry.component + ' ' +
 			((indexEntry.category == IndexEntry::Binary) ? "(binary)" : "(source)");
 
-	shared_ptr< ReleaseInfo > releaseInfo;
+	shared_ptr< const ReleaseInfo > releaseInfo;
 	try
 	{
 		releaseInfo = getReleaseInfo(*config, indexEntry);
-		releaseInfo->component = indexEntry.component;
-		releaseInfo->baseUri = indexEntry.uri;
 
 		if (releaseLimits.isExcluded(*releaseInfo))
 		{
@@ -490,29 +1116,30 @@ void CacheImpl::processIndexEntry(const IndexEntry& indexEntry,
 			sourceReleaseData.push_back(releaseInfo);
 		}
 
-		processIndexFile(indexFileToParse, indexEntry.category, releaseInfo, indexAlias);
+		prepareIndexFile(indexFileToParse, indexEntry.category, releaseInfo, indexAlias, scans);
 	}
 	catch (Exception&)
 	{
 		warn2(__("skipped the index '%s'"), indexAlias);
 	}
 
-	if (releaseInfo && Version::parseInfoOnly) // description is info-only field
+	if (releaseInfo)
 	{
-		processTranslationFiles(indexEntry, indexAlias);
+		// localized descriptions are rarely needed, so read on demand
+		unprocessedTranslationEntries.push_back({ indexEntry, indexAlias });
 	}
 }
 
 void CacheImpl::processTranslationFiles(const IndexEntry& indexEntry,
-		const string& indexAlias)
+		const string& indexAlias, bool writePersistentIndex) const
 {
-	auto process = [this](const string& path, const string& localizationAlias)
+	auto process = [this, writePersistentIndex](const string& path, const string& localizationAlias)
 	{
 		try
 		{
 			if (fs::fileExists(path))
 			{
-				processTranslationFile(path, localizationAlias);
+				processTranslationFile(path, localizationAlias, writePersistentIndex);
 			}
 		}
 		catch (Exception&)
@@ -530,198 +1157,232 @@ void CacheImpl::processTranslationFiles(const IndexEntry& indexEntry,
 	}
 }
 
-void CacheImpl::processIndexFile(const string& path, IndexEntry::Type category,
-		shared_ptr< const ReleaseInfo > releaseInfo, const string& alias)
+void CacheImpl::prepareIndexFile(const string& path, IndexEntry::Type category,
+		shared_ptr< const ReleaseInfo > releaseInfo, const string& alias,
+		vector< IndexFileScan >& scans)
 {
 	using std::make_pair;
-	auto prePackagesStorage = (category == IndexEntry::Binary ?
-			&preBinaryPackages : &preSourcePackages);
 
 	string openError;
-	shared_ptr< File > file(new File(path, "r", openError));
+	shared_ptr< File > file(new File(path, "m", openError));
 	if (!openError.empty())
 	{
 		fatal2(__("unable to open the file '%s': %s"), path, openError);
 	}
 
 	releaseInfoAndFileStorage.push_back(make_pair(releaseInfo, file));
-	PrePackageRecord prePackageRecord;
-	prePackageRecord.offset = 0;
-	prePackageRecord.releaseInfoAndFile = &*(releaseInfoAndFileStorage.rbegin());
 
-	try
+	IndexFileScan scan;
+	scan.path = path;
+	scan.alias = alias;
+	scan.category = category;
+	scan.releaseInfoAndFile = &*(releaseInfoAndFileStorage.rbegin());
+	scan.failed = false;
+	scans.push_back(std::move(scan));
+}
+
+void CacheImpl::scanIndexFiles(vector< IndexFileScan >& scans) const
+{
+	bool usePersistentIndex = config->getBool("cupt::cache::persistent-index");
+	std::unique_ptr< pf::WriteLock > writeLock;
+	if (usePersistentIndex)
 	{
-		pair< const string, vector< PrePackageRecord > > pairForInsertion;
-		string& packageName = const_cast< string& > (pairForInsertion.first);
+		writeLock.reset(new pf::WriteLock(*config, cachefiles::getPathOfListsLock(*config)));
+	}
+	bool writePersistentIndex = writeLock && writeLock->isAcquired();
 
-		while (true)
+	auto scanOne = [usePersistentIndex, writePersistentIndex](IndexFileScan& scan)
+	{
+		ioi::Callbacks callbacks;
+		callbacks.main = [&scan](const string& packageName, size_t offset) -> const string*
 		{
-			const char* buf;
-			size_t size;
-			auto getNextLine = [&file, &buf, &size, &prePackageRecord]
-			{
-				file->rawGetLine(buf, size);
-				prePackageRecord.offset += size;
-			};
+			scan.records.push_back(make_pair(packageName, offset));
+			return &packageName;
+		};
+		callbacks.provides = [&scan](const string*, const char* begin, const char* end)
+		{
+			scan.provides.push_back(make_pair(scan.records.size() - 1, string(begin, end)));
+		};
+		callbacks.report = [&scan](const char* prefix, const string& message)
+		{
+			scan.messages.push_back(make_pair(prefix, message));
+		};
 
-			getNextLine();
-			if (file->eof())
-			{
-				break;
-			}
+		try
+		{
+			ioi::processIndex(scan.path, callbacks, scan.alias, usePersistentIndex, writePersistentIndex);
+		}
+		catch (Exception&)
+		{
+			scan.failed = true;
+		}
+	};
 
-			static const size_t packageAnchorLength = sizeof("Package: ") - 1;
-			if (size > packageAnchorLength && !memcmp("Package: ", buf, packageAnchorLength))
-			{
-				packageName.assign(buf + packageAnchorLength, size - packageAnchorLength - 1);
-			}
-			else
-			{
-				fatal2(__("unable to find a Package line"));
-			}
+	// index files are distributed dynamically since their sizes vary a lot
+	threadpool::ThreadPool::runOnce(scans.size(), config->getInteger("cupt::cache::index-loading-threads"),
+			[&scans, &scanOne](size_t scanIndex) { scanOne(scans[scanIndex]); });
+}
 
-			try
-			{
-				checkPackageName(packageName);
-			}
-			catch (Exception&)
-			{
-				warn2(__("discarding this package version from the index '%s'"), alias);
-				while (getNextLine(), size > 1) {}
-				continue;
-			}
+void CacheImpl::mergeIndexFileScan(const IndexFileScan& scan)
+{
+	auto prePackagesStorage = (scan.category == IndexEntry::Binary ?
+			&preBinaryPackages : &preSourcePackages);
 
-			auto it = prePackagesStorage->insert(pairForInsertion).first;
-			it->second.push_back(prePackageRecord);
+	PrePackageRecord prePackageRecord;
+	prePackageRecord.releaseInfoAndFile = scan.releaseInfoAndFile;
 
-			while (getNextLine(), size > 1)
-			{
-				static const size_t providesAnchorLength = sizeof("Provides: ") - 1;
-				if (*buf == 'P' && size > providesAnchorLength && !memcmp("rovides: ", buf+1, providesAnchorLength-1))
-				{
-					processProvides(&it->first, buf + providesAnchorLength, buf + size - 1);
-				}
-			}
-		}
+	pair< const string, vector< PrePackageRecord > > pairForInsertion;
+	string& packageName = const_cast< string& > (pairForInsertion.first);
+
+	vector< const string* > packageNamePtrs;
+	packageNamePtrs.reserve(scan.records.size());
+	FORIT(recordIt, scan.records)
+	{
+		packageName = recordIt->first;
+		prePackageRecord.offset = recordIt->second;
+
+		auto it = prePackagesStorage->insert(pairForInsertion).first;
+		it->second.push_back(prePackageRecord);
+		packageNamePtrs.push_back(&it->first);
 	}
-	catch (Exception&)
+
+	FORIT(providesIt, scan.provides)
 	{
-		fatal2(__("unable to parse the index '%s'"), alias);
+		const string& providesString = providesIt->second;
+		processProvides(packageNamePtrs[providesIt->first],
+				providesString.data(), providesString.data() + providesString.size(), false);
 	}
 }
 
-void CacheImpl::processTranslationFile(const string& path, const string& alias)
+void CacheImpl::processTranslationFile(const string& path, const string& alias,
+		bool writePersistentIndex) const
 {
+	TranslationFile translationFile;
+
 	string errorString;
-	shared_ptr< File > file(new File(path, "r", errorString));
+	translationFile.file.reset(new File(path, "m", errorString));
 	if (!errorString.empty())
 	{
 		fatal2(__("unable to open the file '%s': %s"), path, errorString);
 	}
+	translationFile.index.reset(new tri::Index(path, alias,
+			config->getBool("cupt::cache::persistent-index"), writePersistentIndex));
 
-	try
-	{
-		TagParser parser(&*file);
-		TagParser::StringRange tagName, tagValue;
-
-		static const char descriptionSubPattern[] = "Description-";
-		static const size_t descriptionSubPatternSize = sizeof(descriptionSubPattern) - 1;
+	translationFiles.push_back(std::move(translationFile));
+}
 
-		size_t recordPosition;
+void CacheImpl::parsePreferences()
+{
+	pinInfo.reset(new PinInfo(config, systemState, releases));
+}
 
-		string md5;
-		TranslationPosition translationPosition;
-		translationPosition.file = file;
+ssize_t CacheImpl::getPin(const shared_ptr< const Version >& version,
+		const std::function< string () >& getInstalledVersionString) const
+{
+	if (!Cache::memoize)
+	{
+		return pinInfo->getPin(version, getInstalledVersionString());
+	}
 
-		while (true)
+	// pins of all versions of the package are computed at once
+	bool isBinary = dynamic_cast< const BinaryVersion* >(version.get());
+	auto packageName = stringpool::intern(version->packageName);
+	auto& storage = isBinary ? binaryPinCache : sourcePinCache;
+	auto it = storage.find(packageName);
+	if (it == storage.end())
+	{
+		shared_ptr< const Package > package;
+		if (isBinary)
 		{
-			recordPosition = file->tell();
-			if (!parser.parseNextLine(tagName, tagValue))
-			{
-				if (file->eof()) break; else continue;
-			}
-
-			bool hashSumFound = false;
-			bool translationFound = false;
-
-			do
-			{
-				if (tagName.equal(BUFFER_AND_SIZE("Description-md5")))
-				{
-					hashSumFound = true;
-					md5 = tagValue;
-				}
-				else if ((size_t)(tagName.second - tagName.first) > descriptionSubPatternSize &&
-						!memcmp(&*tagName.first, descriptionSubPattern, descriptionSubPatternSize))
-				{
-					translationFound = true;
-					translationPosition.offset = file->tell() - (tagValue.second - tagValue.first) - 1; // -1 for '\n'
-				}
-			} while (parser.parseNextLine(tagName, tagValue));
-
-			if (!hashSumFound)
-			{
-				fatal2(__("unable to find the md5 hash in the record starting at byte '%u'"), recordPosition);
-			}
-			if (!translationFound)
-			{
-				fatal2(__("unable to find the translation in the record starting at byte '%u'"), recordPosition);
-			}
+			package = getBinaryPackage(*packageName);
+		}
+		else
+		{
+			package = getSourcePackage(*packageName);
+		}
+		auto versions = package ? package->Package::getVersions() : vector< shared_ptr< const Version > >();
+		auto pins = pinInfo->getPins(versions, getInstalledVersionString());
 
-			translations.insert({ std::move(md5), translationPosition });
+		vector< pair< const string*, ssize_t > > packagePins;
+		for (size_t i = 0; i < versions.size(); ++i)
+		{
+			packagePins.push_back({ stringpool::intern(versions[i]->versionString), pins[i] });
 		}
+		it = storage.insert({ packageName, std::move(packagePins) }).first;
 	}
-	catch(Exception&)
+
+	auto versionString = stringpool::find(version->versionString);
+	FORIT(pinIt, it->second)
 	{
-		fatal2(__("unable to parse the index '%s'"), alias);
+		if (pinIt->first == versionString)
+		{
+			return pinIt->second;
+		}
 	}
+	return pinInfo->getPin(version, getInstalledVersionString()); // not from this cache
 }
 
-void CacheImpl::parsePreferences()
+vector< ssize_t > CacheImpl::getPins(const vector< shared_ptr< const Version > >& versions,
+		const string& installedVersionString) const
 {
-	pinInfo.reset(new PinInfo(config, systemState));
+	return pinInfo->getPins(versions, installedVersionString);
 }
 
-ssize_t CacheImpl::getPin(const shared_ptr< const Version >& version,
-		const std::function< string () >& getInstalledVersionString) const
+pair< string, string > CacheImpl::getLocalizedDescriptions(const shared_ptr< const BinaryVersion >& version) const
 {
-	if (Cache::memoize)
+	if (!unprocessedTranslationEntries.empty())
 	{
-		auto it = pinCache.find(version);
-		if (it != pinCache.end())
+		pf::WriteLock writeLock(*config, cachefiles::getPathOfListsLock(*config));
+		FORIT(entryIt, unprocessedTranslationEntries)
 		{
-			return it->second;
+			processTranslationFiles(entryIt->first, entryIt->second, writeLock.isAcquired());
 		}
+		unprocessedTranslationEntries.clear();
 	}
 
-	auto result = pinInfo->getPin(version, getInstalledVersionString());
-	if (Cache::memoize)
+	if (translationFiles.empty())
 	{
-		pinCache.insert({ version, result });
+		return pair< string, string >();
 	}
-	return result;
-}
 
-pair< string, string > CacheImpl::getLocalizedDescriptions(const shared_ptr< const BinaryVersion >& version) const
-{
-	static const string descriptionHashFieldName = "Description-md5";
-
-	const string& sourceHash = (version->others && version->others->count(descriptionHashFieldName)) ?
-			version->others->find(descriptionHashFieldName)->second :
-			HashSums::getHashOfString(HashSums::MD5, version->shortDescription + "\n" + version->longDescription);
+	tri::Digest digest;
+	const string& sourceHash = version->_description_hash;
+	if (!sourceHash.empty())
+	{
+		if (!tri::parseDigest(sourceHash.data(), sourceHash.data() + sourceHash.size(), digest))
+		{
+			return pair< string, string >();
+		}
+	}
+	else
+	{
+		const string& shortDescription = version->shortDescription;
+		const string& longDescription = version->longDescription;
+		md5::Hasher hasher;
+		hasher.process(shortDescription.data(), shortDescription.size());
+		hasher.process("\n", 1);
+		hasher.process(longDescription.data(), longDescription.size());
+		hasher.getResult(digest.bytes);
+	}
 
-	auto it = translations.find(sourceHash);
-	if (it != translations.end())
+	FORIT(translationFileIt, translationFiles)
 	{
-		const TranslationPosition& position = it->second;
-		string combinedDescription;
-		position.file->seek(position.offset);
-		position.file->getRecord(combinedDescription);
+		auto offset = translationFileIt->index->find(digest);
+		if (offset == -1)
+		{
+			continue;
+		}
+		const char* buffer;
+		size_t size;
+		translationFileIt->file->seek(offset);
+		translationFileIt->file->rawGetRecord(buffer, size);
 
-		auto firstNewLinePosition = combinedDescription.find('\n');
+		auto bufferEnd = buffer + size;
+		auto firstNewLinePosition = std::find(buffer, bufferEnd, '\n');
+		auto secondLineStart = std::min(firstNewLinePosition + 1, bufferEnd);
 
-		return make_pair(combinedDescription.substr(0, firstNewLinePosition),
-				combinedDescription.substr(firstNewLinePosition+1));
+		return make_pair(string(buffer, firstNewLinePosition),
+				string(secondLineStart, bufferEnd));
 	}
 	return pair< string, string >();
 }
@@ -793,16 +1454,15 @@ void CacheImpl::parseExtendedStates()
 vector< shared_ptr< const BinaryVersion > >
 CacheImpl::getSatisfyingVersions(const RelationExpression& relationExpression) const
 {
-	string memoizeKey;
 	if (Cache::memoize)
 	{
 		// caching results
-		memoizeKey = relationExpression.getHashString();
-		auto it = getSatisfyingVersionsCache.find(memoizeKey);
-		if (it != getSatisfyingVersionsCache.end())
+		if (auto memoized = getSatisfyingVersionsCache.find(relationExpression))
 		{
-			return it->second;
+			++getSatisfyingVersionsCacheHitCount;
+			return *memoized;
 		}
+		++getSatisfyingVersionsCacheMissCount;
 	}
 
 	auto result = getSatisfyingVersions(relationExpression[0]);
@@ -826,8 +1486,7 @@ CacheImpl::getSatisfyingVersions(const RelationExpression& relationExpression) c
 
 	if (Cache::memoize)
 	{
-		getSatisfyingVersionsCache.insert(
-				pair< const string, decltype(result) >(std::move(memoizeKey), result));
+		getSatisfyingVersionsCache.add(relationExpression, result);
 	}
 
 	return result;
@@ -27,11 +27,22 @@
 #include <cupt/fwd.hpp>
 #include <cupt/cache.hpp>
 
+#include <internal/arena.hpp>
+#include <internal/packagecontext.hpp>
+#include <internal/relationexpressionmemo.hpp>
+#include <internal/relationparser.hpp>
+
 namespace cupt {
 namespace internal {
 
 class PinInfo;
 class ReleaseLimits;
+namespace tri {
+class Index;
+}
+namespace lru {
+class VersionLru;
+}
 
 using std::list;
 using std::unordered_map;
@@ -51,36 +62,98 @@ class CacheImpl
  private:
 	typedef Cache::IndexEntry IndexEntry;
 	typedef Cache::ExtendedInfo ExtendedInfo;
-	struct TranslationPosition
+	struct TranslationFile
 	{
 		shared_ptr< File > file;
-		size_t offset;
+		shared_ptr< tri::Index > index;
+	};
+	struct IndexFileScan;
+	struct ReverseProvideRecord
+	{
+		// kept here, so neither reparsing the provider nor changes of its
+		// list of versions affect queries
+		shared_ptr< const BinaryVersion > version;
+	};
+	struct ReverseDependencyRecord
+	{
+		uint32_t targetVersionIndex;
+		uint32_t relationType;
+		const string* packageName; // pooled
+		uint32_t versionIndex;
+		uint32_t relationExpressionIndex;
+	};
+	struct ReverseDependencyCandidate
+	{
+		relationparser::Record relation;
+		const string* packageName; // pooled, of the depending package
+		uint32_t versionIndex;
+		uint32_t relationType;
+		uint32_t relationExpressionIndex;
 	};
 
-	map< string, set< const string* > > canProvide;
+	// declared first to be released after everything allocated from it
+	arena::ArenaPtr arena;
+	// virtual package name -> names of packages providing it, and whether they
+	// do it in the installed metadata or in the indexes
+	unordered_map< const string* /* pooled */, set< pair< const string* /* pooled */, bool > > > canProvide;
+	// virtual package name -> [begin, end) of records of its providers
+	mutable unordered_map< const string* /* pooled */, pair< uint32_t, uint32_t > > reverseProvidesIndex;
+	mutable vector< ReverseProvideRecord > reverseProvideRecords;
+	mutable bool reverseProvidesIndexIsBuilt;
+	// referred package name -> [begin, end) of candidates of relations to it
+	mutable unordered_map< const string* /* pooled */, pair< uint32_t, uint32_t > > reverseDependencyCandidateIndex;
+	mutable vector< ReverseDependencyCandidate > reverseDependencyCandidates;
+	mutable bool reverseDependencyCandidatesAreBuilt;
+	// package name -> records of relations satisfied by its versions, built on demand
+	mutable unordered_map< const string* /* pooled */, vector< ReverseDependencyRecord > > reverseDependencyRecords;
+	// packages with the versions of all loaded parts; their pre-records are
+	// freed once they are built
+	mutable unordered_map< string, shared_ptr< Package > > completeBinaryPackages;
+	// packages with the versions of the visible parts
 	mutable unordered_map< string, shared_ptr< Package > > binaryPackages;
 	mutable unordered_map< string, shared_ptr< Package > > sourcePackages;
-	map< string, TranslationPosition > translations;
-	mutable unordered_map< string, vector< shared_ptr< const BinaryVersion > > > getSatisfyingVersionsCache;
+	mutable vector< TranslationFile > translationFiles;
+	mutable vector< pair< IndexEntry, string > > unprocessedTranslationEntries;
+	mutable RelationExpressionMemo getSatisfyingVersionsCache;
+	mutable size_t getSatisfyingVersionsCacheHitCount;
+	mutable size_t getSatisfyingVersionsCacheMissCount;
 	shared_ptr< PinInfo > pinInfo;
-	mutable map< shared_ptr< const Version >, ssize_t > pinCache;
-	map< string, shared_ptr< ReleaseInfo > > releaseInfoCache;
+	// package name -> pins of its versions
+	mutable unordered_map< const string* /* pooled */, vector< pair< const string* /* pooled */, ssize_t > > >
+			binaryPinCache;
+	mutable unordered_map< const string* /* pooled */, vector< pair< const string* /* pooled */, ssize_t > > >
+			sourcePinCache;
+	map< string, shared_ptr< ReleaseInfo > > releaseInfoCache; // parsed Release files
+	map< pair< string, string >, shared_ptr< const ReleaseInfo > > releaseInfoRecords; // (Release path, component)
 	smatch* __smatch_ptr;
+	bool sourceLoaded;
+	bool binaryLoaded;
+	bool installedLoaded;
+	vector< string > packageNameGlobsToReinstall;
 
 	shared_ptr< Package > newSourcePackage(const string&) const;
 	shared_ptr< Package > newBinaryPackage(const string&) const;
-	shared_ptr< Package > preparePackage(unordered_map< string, vector< PrePackageRecord > >&,
-			unordered_map< string, shared_ptr< Package > >&, const string&,
-			decltype(&CacheImpl::newBinaryPackage)) const;
-	shared_ptr< ReleaseInfo > getReleaseInfo(const Config&, const IndexEntry&);
+	shared_ptr< Package > getCompleteBinaryPackage(const string&) const;
+	bool areAllBinaryPartsVisible() const;
+	shared_ptr< const ReleaseInfo > getReleaseInfo(const Config&, const IndexEntry&);
 	void parseSourceList(const string& path);
-	void processIndexEntry(const IndexEntry&, const ReleaseLimits&);
-	void processIndexFile(const string& path, IndexEntry::Type category,
-			shared_ptr< const ReleaseInfo >, const string&);
-	void processTranslationFiles(const IndexEntry&, const string&);
-	void processTranslationFile(const string& path, const string&);
+	void processIndexEntry(const IndexEntry&, const ReleaseLimits&, vector< IndexFileScan >&);
+	void prepareIndexFile(const string& path, IndexEntry::Type category,
+			shared_ptr< const ReleaseInfo >, const string&, vector< IndexFileScan >&);
+	void scanIndexFiles(vector< IndexFileScan >&) const;
+	void mergeIndexFileScan(const IndexFileScan&);
+	void processTranslationFiles(const IndexEntry&, const string&, bool writePersistentIndex) const;
+	void processTranslationFile(const string& path, const string&, bool writePersistentIndex) const;
 	vector< shared_ptr< const BinaryVersion > > getSatisfyingVersions(const Relation&) const;
+	void buildReverseProvidesIndex() const;
+	void buildReverseDependencyCandidates() const;
+	const vector< ReverseDependencyRecord >& getReverseDependencyRecords(const string*,
+			const VersionRange< BinaryVersion >&) const;
+	void setPackageNameGlobsToReinstall(const vector< string >&);
  public:
+	// assigns the identifier and makes the record shared and immutable
+	shared_ptr< const ReleaseInfo > registerRelease(const shared_ptr< ReleaseInfo >&);
+
 	shared_ptr< const Config > config;
 	shared_ptr< const string > binaryArchitecture;
 	vector< shared_ptr< sregex > > packageNameRegexesToReinstall;
@@ -88,24 +161,38 @@ class CacheImpl
 	vector< IndexEntry > indexEntries;
 	vector< shared_ptr< const ReleaseInfo > > sourceReleaseData;
 	vector< shared_ptr< const ReleaseInfo > > binaryReleaseData;
+	vector< shared_ptr< const ReleaseInfo > > releases; // indexed by release identifiers
 	mutable unordered_map< string, vector< PrePackageRecord > > preSourcePackages;
 	mutable unordered_map< string, vector< PrePackageRecord > > preBinaryPackages;
 	list< pair< shared_ptr< const ReleaseInfo >, shared_ptr< File > > >
 			releaseInfoAndFileStorage;
 	ExtendedInfo extendedInfo;
+	shared_ptr< PackageContext > packageContext; // shared with the packages
+	// loaded parts which are visible
+	bool useSource;
+	bool useBinary;
+	bool useInstalled;
 
 	CacheImpl();
 	~CacheImpl();
 	void parseSourcesLists();
+	void load(bool useSource, bool useBinary, bool useInstalled, const vector< string >& packageNameGlobsToReinstall);
 	void processIndexEntries(bool, bool);
 	void parsePreferences();
 	void parseExtendedStates();
 	shared_ptr< const BinaryPackage > getBinaryPackage(const string& packageName) const;
 	shared_ptr< const SourcePackage > getSourcePackage(const string& packageName) const;
+	bool isBinaryReleaseVisible(const ReleaseInfo&) const;
+	vector< string > getBinaryPackageNames() const;
+	vector< string > getSourcePackageNames() const;
 	ssize_t getPin(const shared_ptr< const Version >&, const std::function< string () >&) const;
+	vector< ssize_t > getPins(const vector< shared_ptr< const Version > >&,
+			const string& installedVersionString) const;
 	pair< string, string > getLocalizedDescriptions(const shared_ptr< const BinaryVersion >&) const;
-	void processProvides(const string*, const char*, const char*);
+	void processProvides(const string*, const char*, const char*, bool installed);
 	vector< shared_ptr< const BinaryVersion > > getSatisfyingVersions(const RelationExpression&) const;
+	vector< Cache::ReverseDependency > getReverseDependencies(const shared_ptr< const BinaryVersion >&,
+			BinaryVersion::RelationTypes::Type) const;
 };
 
 }
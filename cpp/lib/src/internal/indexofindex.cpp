@@ -0,0 +1,294 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#include <cstring>
+
+#include <internal/indexofindex.hpp>
+#include <internal/indexscanner.hpp>
+#include <internal/mappedfile.hpp>
+#include <internal/persistentfile.hpp>
+
+namespace cupt {
+namespace internal {
+namespace ioi {
+
+namespace {
+
+const pf::Format format = { { 'c', 'u', 'p', 't', '-', 'i', 'o', 'i' }, 1 };
+
+struct Header
+{
+	uint32_t recordCount;
+	uint32_t stringPoolSize;
+};
+
+struct Record
+{
+	uint64_t offset;
+	uint32_t nameStart;
+	uint32_t nameSize;
+	uint32_t providesStart;
+	uint32_t providesSize; // 0 means 'no provides'
+};
+
+// what is being written after the index is parsed
+struct Collector
+{
+	vector< Record > records;
+	string stringPool;
+
+	uint32_t addString(const char* data, size_t size)
+	{
+		uint32_t result = stringPool.size();
+		stringPool.append(data, size);
+		return result;
+	}
+};
+
+bool processIndexOfIndex(const string& indexPath, const Callbacks& callbacks)
+{
+	pf::Signature indexSignature;
+	if (!pf::getSignature(indexPath, indexSignature))
+	{
+		return false;
+	}
+
+	pf::Reader reader(getIndexOfIndexPath(indexPath), format, indexSignature);
+	auto data = reader.getBody();
+	if (!reader.isValid() || reader.getBodySize() < sizeof(Header))
+	{
+		return false;
+	}
+
+	Header header;
+	memcpy(&header, data, sizeof(header));
+	if (reader.getBodySize() != sizeof(Header) +
+			uint64_t(header.recordCount) * sizeof(Record) + header.stringPoolSize)
+	{
+		return false; // truncated
+	}
+
+	auto records = reinterpret_cast< const Record* >(data + sizeof(Header));
+	auto stringPool = data + sizeof(Header) + header.recordCount * sizeof(Record);
+	auto isInPool = [&header](uint32_t start, uint32_t size)
+	{
+		return uint64_t(start) + size <= header.stringPoolSize;
+	};
+	for (uint32_t i = 0; i < header.recordCount; ++i)
+	{
+		if (!isInPool(records[i].nameStart, records[i].nameSize) ||
+				!isInPool(records[i].providesStart, records[i].providesSize))
+		{
+			return false;
+		}
+	}
+
+	string packageName;
+	for (uint32_t i = 0; i < header.recordCount; ++i)
+	{
+		const Record& record = records[i];
+		packageName.assign(stringPool + record.nameStart, record.nameSize);
+		auto packageNamePtr = callbacks.main(packageName, record.offset);
+		if (record.providesSize)
+		{
+			auto providesStart = stringPool + record.providesStart;
+			callbacks.provides(packageNamePtr, providesStart, providesStart + record.providesSize);
+		}
+	}
+
+	return true;
+}
+
+void report(const Callbacks& callbacks, const char* prefix, const string& message)
+{
+	if (callbacks.report)
+	{
+		callbacks.report(prefix, message);
+	}
+	else
+	{
+		__mwrite_line(prefix, message);
+	}
+}
+
+template < typename... Args >
+void fail(const Callbacks& callbacks, const string& format, const Args&... args)
+{
+	auto message = format2(format, args...);
+	report(callbacks, "E: ", message);
+	throw Exception(message);
+}
+
+void parseFullIndex(const string& indexPath, const Callbacks& callbacks,
+		const string& alias, MappedFile::Access access, Collector* collector)
+{
+	string openError;
+	MappedFile mappedFile(indexPath, access, &openError);
+	if (!openError.empty())
+	{
+		fail(callbacks, __("unable to open the file '%s': %s"), indexPath, openError);
+	}
+
+	const char* const begin = mappedFile.data();
+	const char* const end = begin + mappedFile.size();
+	auto getLineEnd = [end](const char* lineBegin)
+	{
+		auto newLinePosition = static_cast< const char* >(memchr(lineBegin, '\n', end - lineBegin));
+		return newLinePosition ? newLinePosition : end;
+	};
+
+	static const size_t packageAnchorLength = sizeof("Package: ") - 1;
+	static const size_t providesAnchorLength = sizeof("Provides: ") - 1;
+
+	string packageName;
+	const char* recordBegin = begin;
+	while (recordBegin != end)
+	{
+		auto packageLineEnd = getLineEnd(recordBegin);
+		if (size_t(packageLineEnd - recordBegin) >= packageAnchorLength &&
+				!memcmp("Package: ", recordBegin, packageAnchorLength))
+		{
+			packageName.assign(recordBegin + packageAnchorLength, packageLineEnd);
+		}
+		else
+		{
+			fail(callbacks, __("unable to find a Package line"));
+		}
+
+		bool packageNameIsValid = checkPackageName(packageName, false);
+		if (!packageNameIsValid)
+		{
+			report(callbacks, "E: ", format2(__("invalid package name '%s'"), packageName));
+			report(callbacks, "W: ", format2(__("discarding this package version from the index '%s'"), alias));
+		}
+
+		const string* packageNamePtr = NULL;
+		Record* record = NULL;
+		if (packageNameIsValid)
+		{
+			size_t offset = std::min(packageLineEnd + 1, end) - begin;
+			packageNamePtr = callbacks.main(packageName, offset);
+			if (collector)
+			{
+				collector->records.push_back(Record());
+				record = &collector->records.back();
+				record->offset = offset;
+				record->nameStart = collector->addString(packageName.data(), packageName.size());
+				record->nameSize = packageName.size();
+				record->providesStart = 0;
+				record->providesSize = 0;
+			}
+		}
+
+		// only lines starting with 'P' and empty lines are interesting here
+		const char* recordEnd = end;
+		const char* candidate = packageLineEnd;
+		while ((candidate = scanner::findAnchorCandidate(candidate, end)) != end)
+		{
+			const char* lineBegin = candidate + 1;
+			if (*lineBegin == '\n')
+			{
+				recordEnd = lineBegin + 1;
+				break;
+			}
+			if (packageNamePtr && size_t(end - lineBegin) > providesAnchorLength &&
+					!memcmp("Provides: ", lineBegin, providesAnchorLength))
+			{
+				auto providesStart = lineBegin + providesAnchorLength;
+				auto providesEnd = getLineEnd(providesStart);
+				callbacks.provides(packageNamePtr, providesStart, providesEnd);
+				if (record)
+				{
+					record->providesStart = collector->addString(providesStart, providesEnd - providesStart);
+					record->providesSize = providesEnd - providesStart;
+				}
+			}
+			candidate = lineBegin;
+		}
+		recordBegin = recordEnd;
+	}
+}
+
+// 'indexSignature' is the one taken before parsing the index, the index of
+// index is not written if the index was changed since then
+void writeIndexOfIndex(const string& indexPath, const pf::Signature& indexSignature,
+		const Collector& collector)
+{
+	pf::Signature currentIndexSignature;
+	if (!pf::getSignature(indexPath, currentIndexSignature) || !(currentIndexSignature == indexSignature))
+	{
+		return;
+	}
+	Header header;
+	header.recordCount = collector.records.size();
+	header.stringPoolSize = collector.stringPool.size();
+
+	pf::write(getIndexOfIndexPath(indexPath), format, indexSignature, [&header, &collector](pf::Writer& writer)
+	{
+		writer.put(reinterpret_cast< const char* >(&header), sizeof(header));
+		if (!collector.records.empty())
+		{
+			writer.put(reinterpret_cast< const char* >(&collector.records[0]),
+					collector.records.size() * sizeof(Record));
+		}
+		writer.put(collector.stringPool);
+	});
+}
+
+}
+
+string getIndexOfIndexPath(const string& indexPath)
+{
+	return indexPath + ".ioi";
+}
+
+void processIndex(const string& indexPath, const Callbacks& callbacks,
+		const string& alias, bool usePersistentIndex, bool writePersistentIndex)
+{
+	if (usePersistentIndex && processIndexOfIndex(indexPath, callbacks))
+	{
+		return;
+	}
+
+	// the index may be changed by an update otherwise
+	auto access = writePersistentIndex ? MappedFile::Access::Map : MappedFile::Access::Read;
+	pf::Signature indexSignature;
+	if (usePersistentIndex && writePersistentIndex && pf::getSignature(indexPath, indexSignature))
+	{
+		Collector collector;
+		parseFullIndex(indexPath, callbacks, alias, access, &collector);
+		writeIndexOfIndex(indexPath, indexSignature, collector);
+	}
+	else
+	{
+		parseFullIndex(indexPath, callbacks, alias, access, NULL);
+	}
+}
+
+void generate(const string& indexPath, const string& alias)
+{
+	Callbacks callbacks;
+	callbacks.main = [](const string& packageName, size_t) { return &packageName; };
+	callbacks.provides = [](const string*, const char*, const char*) {};
+
+	processIndex(indexPath, callbacks, alias, true, true);
+}
+
+}
+}
+}
+
@@ -0,0 +1,65 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#ifndef CUPT_INTERNAL_INDEXOFINDEX_SEEN
+#define CUPT_INTERNAL_INDEXOFINDEX_SEEN
+
+#include <functional>
+
+#include <cupt/common.hpp>
+
+namespace cupt {
+namespace internal {
+
+// "index of index": a persistent binary digest of a Packages/Sources file
+// which contains package names, record offsets and provides, so the index
+// itself doesn't have to be scanned on every cache construction
+namespace ioi {
+
+struct Callbacks
+{
+	// receives a package name and an offset of the record body (right
+	// after the 'Package:' line), returns a pointer to a persistent copy
+	// of the package name
+	std::function< const string* (const string&, size_t) > main;
+	std::function< void (const string*, const char*, const char*) > provides;
+	// if set, receives the lines of warnings and errors ("W: ", "E: ") instead
+	// of them being printed, so the index may be processed outside the main
+	// thread; errors are still thrown
+	std::function< void (const char* prefix, const string& message) > report;
+};
+
+string getIndexOfIndexPath(const string& indexPath);
+
+// feeds the callbacks either from the valid index of index or from the index
+// itself; in the latter case the index of index is (re)generated if
+// 'writePersistentIndex' is true, the caller has to hold the lists lock then;
+// if 'usePersistentIndex' is false, only the index itself is used
+void processIndex(const string& indexPath, const Callbacks&,
+		const string& alias, bool usePersistentIndex, bool writePersistentIndex);
+
+// (re)generates the index of index if it is out of date; the caller has to
+// hold the lists lock
+void generate(const string& indexPath, const string& alias);
+
+}
+
+}
+}
+
+#endif
+
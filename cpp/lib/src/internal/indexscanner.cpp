@@ -0,0 +1,176 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#include <cstring>
+#include <cstdint>
+
+#include <internal/indexscanner.hpp>
+
+#if defined(__SSE2__)
+#define CUPT_SCANNER_SSE2
+#include <emmintrin.h>
+#endif
+
+// per-function target attributes for intrinsics appeared in GCC 4.9
+#if defined(__x86_64__) && defined(__GNUC__) && \
+		(__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define CUPT_SCANNER_AVX2
+#include <immintrin.h>
+#endif
+
+namespace cupt {
+namespace internal {
+namespace scanner {
+
+const char* findAnchorCandidateScalar(const char* begin, const char* end)
+{
+	while (begin != end)
+	{
+		auto newLinePosition = static_cast< const char* >(memchr(begin, '\n', end - begin));
+		if (!newLinePosition || newLinePosition + 1 == end)
+		{
+			break;
+		}
+		if (newLinePosition[1] == '\n' || newLinePosition[1] == 'P')
+		{
+			return newLinePosition;
+		}
+		begin = newLinePosition + 1;
+	}
+	return end;
+}
+
+namespace {
+
+// each vectorized variant handles 64-byte blocks: it builds bit masks of
+// newlines and 'P' characters, and a newline is a candidate if the next bit
+// of the combined mask is set; the byte right after the block supplies the
+// last bit, so the block needs one more byte than its size, the tail is
+// handled by the scalar variant
+
+inline uint64_t getCandidateMask(uint64_t newLineMask, uint64_t anchorStartMask, char nextByte)
+{
+	uint64_t followerMask = (newLineMask | anchorStartMask) >> 1;
+	if (nextByte == '\n' || nextByte == 'P')
+	{
+		followerMask |= uint64_t(1) << 63;
+	}
+	return newLineMask & followerMask;
+}
+
+#ifdef CUPT_SCANNER_SSE2
+inline uint64_t getSse2Mask(const char* position, __m128i pattern)
+{
+	uint64_t result = 0;
+	for (size_t i = 0; i < 4; ++i)
+	{
+		__m128i chunk = _mm_loadu_si128(reinterpret_cast< const __m128i* >(position + 16*i));
+		result |= uint64_t(uint16_t(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, pattern)))) << (16*i);
+	}
+	return result;
+}
+
+const char* findAnchorCandidateSse2(const char* begin, const char* end)
+{
+	const __m128i newLines = _mm_set1_epi8('\n');
+	const __m128i anchorStarts = _mm_set1_epi8('P');
+	while (end - begin > 64)
+	{
+		uint64_t mask = getCandidateMask(getSse2Mask(begin, newLines),
+				getSse2Mask(begin, anchorStarts), begin[64]);
+		if (mask)
+		{
+			return begin + __builtin_ctzll(mask);
+		}
+		begin += 64;
+	}
+	return findAnchorCandidateScalar(begin, end);
+}
+#endif
+
+#ifdef CUPT_SCANNER_AVX2
+__attribute__((target("avx2")))
+inline uint64_t getAvx2Mask(const char* position, __m256i pattern)
+{
+	__m256i low = _mm256_loadu_si256(reinterpret_cast< const __m256i* >(position));
+	__m256i high = _mm256_loadu_si256(reinterpret_cast< const __m256i* >(position + 32));
+	return uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, pattern)))) |
+			(uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, pattern)))) << 32);
+}
+
+__attribute__((target("avx2")))
+const char* findAnchorCandidateAvx2(const char* begin, const char* end)
+{
+	const __m256i newLines = _mm256_set1_epi8('\n');
+	const __m256i anchorStarts = _mm256_set1_epi8('P');
+	while (end - begin > 64)
+	{
+		uint64_t mask = getCandidateMask(getAvx2Mask(begin, newLines),
+				getAvx2Mask(begin, anchorStarts), begin[64]);
+		if (mask)
+		{
+			return begin + __builtin_ctzll(mask);
+		}
+		begin += 64;
+	}
+	return findAnchorCandidateScalar(begin, end);
+}
+#endif
+
+struct Implementation
+{
+	const char* (*function)(const char*, const char*);
+	const char* name;
+};
+
+Implementation selectImplementation()
+{
+#ifdef CUPT_SCANNER_AVX2
+	if (__builtin_cpu_supports("avx2"))
+	{
+		return Implementation { findAnchorCandidateAvx2, "avx2" };
+	}
+#endif
+#ifdef CUPT_SCANNER_SSE2
+	return Implementation { findAnchorCandidateSse2, "sse2" };
+#else
+	return Implementation { findAnchorCandidateScalar, "scalar" };
+#endif
+}
+
+const Implementation& getImplementation()
+{
+	static const Implementation implementation = selectImplementation();
+	return implementation;
+}
+
+}
+
+const char* findAnchorCandidate(const char* begin, const char* end)
+{
+	return getImplementation().function(begin, end);
+}
+
+const char* getImplementationName()
+{
+	return getImplementation().name;
+}
+
+}
+}
+}
+
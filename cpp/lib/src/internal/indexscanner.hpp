@@ -0,0 +1,42 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#ifndef CUPT_INTERNAL_INDEXSCANNER_SEEN
+#define CUPT_INTERNAL_INDEXSCANNER_SEEN
+
+namespace cupt {
+namespace internal {
+namespace scanner {
+
+// returns the position of the first newline character in [begin, end) which
+// is followed by either another newline (the end of a record) or 'P' (a
+// possible 'Package:' or 'Provides:' anchor), or 'end' if there is none;
+// the fastest implementation supported by the processor is picked at runtime
+const char* findAnchorCandidate(const char* begin, const char* end);
+
+// "avx2", "sse2" or "scalar"
+const char* getImplementationName();
+
+// the portable implementation, exposed for comparison
+const char* findAnchorCandidateScalar(const char* begin, const char* end);
+
+}
+}
+}
+
+#endif
+
@@ -0,0 +1,144 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#include <cerrno>
+#include <cstring>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <internal/mappedfile.hpp>
+
+namespace cupt {
+namespace internal {
+
+namespace {
+
+string getErrorString()
+{
+	char errorBuffer[255] = "?";
+	// error message may not go to errorBuffer, see man strerror_r (GNU version)
+	return strerror_r(errno, errorBuffer, sizeof(errorBuffer));
+}
+
+// reads up to 'size' bytes, less only if the file became shorter
+bool readAll(int fd, char* buffer, size_t& size)
+{
+	size_t readSize = 0;
+	while (readSize < size)
+	{
+		auto result = read(fd, buffer + readSize, size - readSize);
+		if (result == -1)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			return false;
+		}
+		if (result == 0)
+		{
+			break;
+		}
+		readSize += result;
+	}
+	size = readSize;
+	return true;
+}
+
+}
+
+MappedFile::MappedFile(const string& path, Access access, string* openError)
+	: __mapping(MAP_FAILED), __size(0)
+{
+	auto setError = [openError](const string& error)
+	{
+		if (openError)
+		{
+			*openError = error;
+		}
+	};
+
+	int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd == -1)
+	{
+		setError(getErrorString());
+		return;
+	}
+	struct stat st;
+	if (fstat(fd, &st) == -1)
+	{
+		setError(format2e("unable to get file status"));
+	}
+	else if (st.st_size > 0)
+	{
+		size_t size = st.st_size;
+		if (access == Access::Map)
+		{
+			__mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (__mapping == MAP_FAILED)
+			{
+				setError(format2e("unable to map the file into memory"));
+			}
+			else
+			{
+				__size = size;
+			}
+		}
+		else
+		{
+			__buffer.resize(size);
+			if (!readAll(fd, &__buffer[0], size))
+			{
+				setError(format2e("unable to read the file"));
+				size = 0;
+			}
+			__buffer.resize(size);
+			__size = size;
+		}
+	}
+	close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+	if (__mapping != MAP_FAILED)
+	{
+		munmap(__mapping, __size);
+	}
+}
+
+const char* MappedFile::data() const
+{
+	if (__mapping != MAP_FAILED)
+	{
+		return static_cast< const char* >(__mapping);
+	}
+	return __size ? __buffer.data() : NULL;
+}
+
+size_t MappedFile::size() const
+{
+	return __size;
+}
+
+}
+}
+
@@ -0,0 +1,59 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#ifndef CUPT_INTERNAL_MAPPEDFILE_SEEN
+#define CUPT_INTERNAL_MAPPEDFILE_SEEN
+
+#include <cupt/common.hpp>
+
+namespace cupt {
+namespace internal {
+
+// read-only contents of a whole file
+class MappedFile
+{
+	void* __mapping;
+	size_t __size;
+	string __buffer;
+
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+ public:
+	enum class Access
+	{
+		// the file is mapped into memory; accessing the mapping after the file
+		// is truncated raises SIGBUS, so the caller guarantees that it isn't:
+		// either the lists lock is held or the file is only ever replaced by
+		// renaming
+		Map,
+		// the file is read into memory
+		Read
+	};
+
+	// if 'openError' is not NULL, errors are reported there
+	MappedFile(const string& path, Access, string* openError = NULL);
+	~MappedFile();
+	// NULL if the file couldn't be opened or is empty
+	const char* data() const;
+	size_t size() const;
+};
+
+}
+}
+
+#endif
+
@@ -0,0 +1,159 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#include <cstring>
+#include <algorithm>
+
+#include <internal/md5.hpp>
+
+namespace cupt {
+namespace internal {
+namespace md5 {
+
+namespace {
+
+const uint32_t sines[64] = {
+	0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+	0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+	0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+	0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+	0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+	0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+	0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+	0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391 };
+
+const uint8_t shifts[64] = {
+	7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
+	5, 9, 14, 20, 5, 9, 14, 20, 5, 9, 14, 20, 5, 9, 14, 20,
+	4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
+	6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21 };
+
+inline uint32_t rotateLeft(uint32_t value, uint8_t shift)
+{
+	return (value << shift) | (value >> (32 - shift));
+}
+
+}
+
+Hasher::Hasher()
+	: __size(0)
+{
+	__state[0] = 0x67452301;
+	__state[1] = 0xefcdab89;
+	__state[2] = 0x98badcfe;
+	__state[3] = 0x10325476;
+}
+
+void Hasher::__process_block(const uint8_t* block)
+{
+	uint32_t words[16];
+	for (size_t i = 0; i < 16; ++i)
+	{
+		// little endian regardless of the host byte order
+		words[i] = uint32_t(block[4*i]) | (uint32_t(block[4*i+1]) << 8) |
+				(uint32_t(block[4*i+2]) << 16) | (uint32_t(block[4*i+3]) << 24);
+	}
+
+	uint32_t a = __state[0];
+	uint32_t b = __state[1];
+	uint32_t c = __state[2];
+	uint32_t d = __state[3];
+	for (size_t i = 0; i < 64; ++i)
+	{
+		uint32_t f;
+		size_t wordIndex;
+		switch (i / 16)
+		{
+			case 0:
+				f = (b & c) | (~b & d);
+				wordIndex = i;
+				break;
+			case 1:
+				f = (d & b) | (~d & c);
+				wordIndex = (5*i + 1) % 16;
+				break;
+			case 2:
+				f = b ^ c ^ d;
+				wordIndex = (3*i + 5) % 16;
+				break;
+			default:
+				f = c ^ (b | ~d);
+				wordIndex = (7*i) % 16;
+		}
+		uint32_t newB = b + rotateLeft(a + f + sines[i] + words[wordIndex], shifts[i]);
+		a = d;
+		d = c;
+		c = b;
+		b = newB;
+	}
+
+	__state[0] += a;
+	__state[1] += b;
+	__state[2] += c;
+	__state[3] += d;
+}
+
+void Hasher::process(const char* data, size_t size)
+{
+	auto input = reinterpret_cast< const uint8_t* >(data);
+	size_t buffered = __size % 64;
+	__size += size;
+
+	if (buffered)
+	{
+		size_t chunkSize = std::min(size, 64 - buffered);
+		memcpy(__buffer + buffered, input, chunkSize);
+		input += chunkSize;
+		size -= chunkSize;
+		if (buffered + chunkSize < 64)
+		{
+			return;
+		}
+		__process_block(__buffer);
+	}
+	for (; size >= 64; input += 64, size -= 64)
+	{
+		__process_block(input);
+	}
+	memcpy(__buffer, input, size);
+}
+
+void Hasher::getResult(uint8_t (&digest)[16])
+{
+	uint64_t bitSize = __size * 8;
+
+	static const char padding[64] = { char(0x80) };
+	size_t buffered = __size % 64;
+	process(padding, (buffered < 56) ? (56 - buffered) : (120 - buffered));
+
+	char sizeBytes[8];
+	for (size_t i = 0; i < 8; ++i)
+	{
+		sizeBytes[i] = char(bitSize >> (8*i));
+	}
+	process(sizeBytes, sizeof(sizeBytes));
+
+	for (size_t i = 0; i < 16; ++i)
+	{
+		digest[i] = uint8_t(__state[i/4] >> (8*(i%4)));
+	}
+}
+
+}
+}
+}
+
@@ -0,0 +1,53 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#ifndef CUPT_INTERNAL_MD5_SEEN
+#define CUPT_INTERNAL_MD5_SEEN
+
+#include <cstdint>
+
+#include <cupt/common.hpp>
+
+namespace cupt {
+namespace internal {
+
+// MD5 (RFC 1321) for hashing many short strings in memory, where opening a
+// gcrypt handle per string costs more than hashing itself; HashSums is still
+// the interface for verifying files
+namespace md5 {
+
+class Hasher
+{
+	uint32_t __state[4];
+	uint64_t __size;
+	uint8_t __buffer[64];
+
+	void __process_block(const uint8_t*);
+ public:
+	Hasher();
+	void process(const char* data, size_t size);
+	// finishes hashing, the hasher can't be used after that
+	void getResult(uint8_t (&digest)[16]);
+};
+
+}
+
+}
+}
+
+#endif
+
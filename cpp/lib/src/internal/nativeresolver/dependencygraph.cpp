@@ -302,7 +302,7 @@ bool __version_has_relation_expression(const shared_ptr< const BinaryVersion >&
 		const RelationExpression& relationExpression)
 {
 	auto relationExpressionString = relationExpression.getHashString();
-	for (const RelationExpression& candidateRelationExpression: version->relations[dependencyType])
+	for (const RelationExpression& candidateRelationExpression: version->relations[dependencyType].get())
 	{
 		auto candidateString = candidateRelationExpression.getHashString();
 		if (relationExpressionString == candidateString)
@@ -445,12 +445,12 @@ vector< shared_ptr< const BinaryVersion > > __get_versions_by_source_version_str
 	vector< shared_ptr< const BinaryVersion > > result;
 	if (auto package = cache.getBinaryPackage(packageName))
 	{
-		auto versions = package->getVersions();
-		FORIT(versionIt, versions)
+		auto versions = package->getVersionRange();
+		for (auto versionIt = versions.begin(); versionIt != versions.end(); ++versionIt)
 		{
-			if ((*versionIt)->sourceVersionString == sourceVersionString)
+			if (versionIt->sourceVersionString == sourceVersionString)
 			{
-				result.push_back(*versionIt);
+				result.push_back(versionIt.getShared());
 			}
 		}
 	}
@@ -495,6 +495,7 @@ class DependencyGraph::FillHelper
 	unordered_map< string, list< pair< string, const Element* > > > __meta_synchronize_map;
 
 	set< const Element* > __unfolded_elements;
+	bool __frozen;
 
 	bool __can_package_be_removed(const string& packageName) const
 	{
@@ -509,7 +510,8 @@ class DependencyGraph::FillHelper
 			const map< string, InitialPackageEntry >& initialPackages)
 		: __dependency_graph(dependencyGraph),
 		__old_packages(oldPackages), __initial_packages(initialPackages),
-		__debugging(__dependency_graph.__config.getBool("debug::resolver"))
+		__debugging(__dependency_graph.__config.getBool("debug::resolver")),
+		__frozen(false)
 	{
 		__synchronize_level = __get_synchronize_level(__dependency_graph.__config);
 		__dependency_groups= __get_dependency_groups(__dependency_graph.__config);
@@ -548,6 +550,15 @@ class DependencyGraph::FillHelper
 		};
 
 		string versionHashString = packageName + ' ' + (version ? version->versionString : "");
+		if (__frozen)
+		{
+			auto it = __version_to_vertex_ptr.find(versionHashString);
+			if (it == __version_to_vertex_ptr.end())
+			{
+				throw FrozenGraphChange();
+			}
+			return it->second;
+		}
 		auto insertResult = __version_to_vertex_ptr.insert({ std::move(versionHashString), NULL });
 		bool isNew = insertResult.second;
 		const VersionVertex** elementPtrPtr = &insertResult.first->second;
@@ -633,9 +644,10 @@ class DependencyGraph::FillHelper
 				{
 					fatal2i("the binary package '%s' doesn't exist", packageName);
 				}
-				auto packageVersions = package->getVersions();
+				auto packageVersions = package->getVersionRange();
 				const list< const BinaryVersion* >& subSatisfiedVersions = groupIt->second;
-				FORIT(packageVersionIt, packageVersions)
+				for (auto packageVersionIt = packageVersions.begin();
+						packageVersionIt != packageVersions.end(); ++packageVersionIt)
 				{
 					auto predicate = [&packageVersionIt](const BinaryVersion* left) -> bool
 					{
@@ -644,7 +656,7 @@ class DependencyGraph::FillHelper
 					if (std::find_if(subSatisfiedVersions.begin(), subSatisfiedVersions.end(),
 								predicate) == subSatisfiedVersions.end())
 					{
-						if (auto queuedVersionPtr = getVertexPtr(*packageVersionIt))
+						if (auto queuedVersionPtr = getVertexPtr(packageVersionIt.getShared()))
 						{
 							addEdgeCustom(subVertexPtr, queuedVersionPtr);
 						}
@@ -780,8 +792,22 @@ class DependencyGraph::FillHelper
 	}
 
  public:
+	void setFrozen(bool frozen)
+	{
+		__frozen = frozen;
+	}
+
 	void unfoldElement(const Element* elementPtr)
 	{
+		if (__frozen)
+		{
+			auto versionElementPtr = dynamic_cast< const VersionElement* >(elementPtr);
+			if (versionElementPtr && versionElementPtr->version && !__unfolded_elements.count(elementPtr))
+			{
+				throw FrozenGraphChange();
+			}
+			return; // unfolded already or nothing to unfold
+		}
 		if (!__unfolded_elements.insert(elementPtr).second)
 		{
 			return; // processed already
@@ -804,7 +830,7 @@ class DependencyGraph::FillHelper
 			auto dependencyType = dependencyGroupIt->type;
 			auto isDependencyAnti = dependencyGroupIt->isAnti;
 
-			const RelationLine& relationLine = version->relations[dependencyType];
+			const RelationLine& relationLine = version->relations[dependencyType].get();
 			FORIT(relationExpressionIt, relationLine)
 			{
 				const RelationExpression& relationExpression = *relationExpressionIt;
@@ -847,10 +873,10 @@ vector< pair< const dg::Element*, shared_ptr< const PackageEntry > > > Dependenc
 				{
 					const string& packageName = it->first;
 					auto package = __cache.getBinaryPackage(packageName);
-					auto versions = package->getVersions();
-					FORIT(versionIt, versions)
+					auto versions = package->getVersionRange();
+					for (auto versionIt = versions.begin(); versionIt != versions.end(); ++versionIt)
 					{
-						__fill_helper->getVertexPtr(*versionIt);
+						__fill_helper->getVertexPtr(versionIt.getShared());
 					}
 
 					__fill_helper->getVertexPtrForEmptyPackage(packageName); // also, empty one
@@ -877,6 +903,11 @@ void DependencyGraph::unfoldElement(const Element* elementPtr)
 	__fill_helper->unfoldElement(elementPtr);
 }
 
+void DependencyGraph::setFrozen(bool frozen)
+{
+	__fill_helper->setFrozen(frozen);
+}
+
 const Element* DependencyGraph::getCorrespondingEmptyElement(const Element* elementPtr)
 {
 	auto versionVertex = dynamic_cast< const VersionVertex* >(elementPtr);
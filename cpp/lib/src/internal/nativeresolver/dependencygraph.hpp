@@ -98,6 +98,10 @@ struct PointeredAlreadyTraits
 
 }
 
+// thrown by a frozen graph instead of adding vertices or edges
+struct FrozenGraphChange
+{};
+
 class DependencyGraph: protected Graph< const Element*, PointeredAlreadyTraits >
 {
 	const Config& __config;
@@ -118,6 +122,9 @@ class DependencyGraph: protected Graph< const Element*, PointeredAlreadyTraits >
 
 	const Element* getCorrespondingEmptyElement(const Element*);
 	void unfoldElement(const Element*);
+	// while the graph is frozen, it isn't changed and so may be read from
+	// several threads; the calls which would change it throw FrozenGraphChange
+	void setFrozen(bool);
 
 	using BaseT::getSuccessorsFromPointer;
 	using BaseT::getPredecessorsFromPointer;
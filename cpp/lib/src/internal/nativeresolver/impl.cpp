@@ -26,6 +26,7 @@
 #include <cupt/system/state.hpp>
 
 #include <internal/nativeresolver/impl.hpp>
+#include <internal/nativeresolver/minmaxheap.hpp>
 #include <internal/graph.hpp>
 
 namespace cupt {
@@ -208,24 +209,87 @@ struct SolutionScoreLess
 		return left->id > right->id;
 	}
 };
-typedef set< shared_ptr< Solution >, SolutionScoreLess > SolutionContainer;
-typedef std::function< SolutionContainer::iterator (SolutionContainer&) > SolutionChooser;
+typedef MinMaxHeap< shared_ptr< Solution >, SolutionScoreLess > SolutionHeap;
 
-SolutionContainer::iterator __fair_chooser(SolutionContainer& solutions)
+// finished solutions are kept apart from unfinished ones, so every solution
+// choosers need is at an end of one of two heaps
+class SolutionContainer
+{
+	SolutionHeap __unfinished;
+	SolutionHeap __finished;
+ public:
+	struct Position
+	{
+		bool finished;
+		bool greatest; // otherwise the least one
+	};
+
+	bool empty() const
+	{
+		return __unfinished.empty() && __finished.empty();
+	}
+	size_t size() const
+	{
+		return __unfinished.size() + __finished.size();
+	}
+	bool hasUnfinished() const
+	{
+		return !__unfinished.empty();
+	}
+	void insert(const shared_ptr< Solution >& solution)
+	{
+		(solution->finished ? __finished : __unfinished).push(solution);
+	}
+
+	// the container should not be empty
+	Position getBest() const
+	{
+		bool finished = __unfinished.empty() || (!__finished.empty() &&
+				SolutionScoreLess()(__unfinished.getGreatest(), __finished.getGreatest()));
+		return Position { finished, true };
+	}
+	Position getWorst() const
+	{
+		bool finished = __unfinished.empty() || (!__finished.empty() &&
+				SolutionScoreLess()(__finished.getLeast(), __unfinished.getLeast()));
+		return Position { finished, false };
+	}
+	Position getWorstUnfinished() const
+	{
+		return Position { false, false };
+	}
+
+	const shared_ptr< Solution >& get(const Position& position) const
+	{
+		const SolutionHeap& heap = position.finished ? __finished : __unfinished;
+		return position.greatest ? heap.getGreatest() : heap.getLeast();
+	}
+	shared_ptr< Solution > extract(const Position& position)
+	{
+		SolutionHeap& heap = position.finished ? __finished : __unfinished;
+		return position.greatest ? heap.extractGreatest() : heap.extractLeast();
+	}
+
+	// up to 'count' best unfinished solutions, the best first
+	vector< const shared_ptr< Solution >* > getBestUnfinished(size_t count) const
+	{
+		return __unfinished.getGreatest(count);
+	}
+};
+typedef std::function< SolutionContainer::Position (const SolutionContainer&) > SolutionChooser;
+
+SolutionContainer::Position __fair_chooser(const SolutionContainer& solutions)
 {
 	// choose the solution with maximum score
-	return --solutions.end();
+	return solutions.getBest();
 }
 
-SolutionContainer::iterator __full_chooser(SolutionContainer& solutions)
+SolutionContainer::Position __full_chooser(const SolutionContainer& solutions)
 {
 	// defer the decision until all solutions are built
-	FORIT(solutionIt, solutions)
+	if (solutions.hasUnfinished())
 	{
-		if (! (*solutionIt)->finished)
-		{
-			return solutionIt;
-		}
+		return solutions.getWorstUnfinished();
 	}
 
 	// heh, the whole solution tree has been already built?.. ok, let's choose
@@ -510,12 +574,11 @@ void __erase_worst_solutions(SolutionContainer& solutions,
 	while (solutions.size() > maxSolutionCount)
 	{
 		// drop the worst solution
-		auto worstSolutionIt = solutions.begin();
+		auto worstSolution = solutions.extract(solutions.getWorst());
 		if (debugging)
 		{
-			__mydebug_wrapper(**worstSolutionIt, "dropped");
+			__mydebug_wrapper(*worstSolution, "dropped");
 		}
-		solutions.erase(worstSolutionIt);
 		if (!thereWereDrops)
 		{
 			thereWereDrops = true;
@@ -549,6 +612,47 @@ void NativeResolverImpl::__post_apply_action(Solution& solution)
 	solution.pendingAction.reset();
 }
 
+/* the best pending solutions are likely to be picked up soon, so their actions
+   are applied in advance on several threads; the dependency graph is frozen
+   meanwhile, and the solutions whose actions would change it are left
+   untouched, so the applied changes are exactly the ones __post_apply_action
+   would make when the solution is picked up, and the resolving result doesn't
+   depend on the number of threads */
+
+vector< Solution* > __get_best_pending_solutions(const SolutionContainer& solutions, size_t count)
+{
+	vector< Solution* > result;
+	for (auto solutionPtr: solutions.getBestUnfinished(count))
+	{
+		if ((*solutionPtr)->pendingAction)
+		{
+			result.push_back(solutionPtr->get());
+		}
+	}
+	return result;
+}
+
+void NativeResolverImpl::__post_apply_actions_concurrently(threadpool::ThreadPool& threadPool,
+		const vector< Solution* >& solutions)
+{
+	auto apply = [this](Solution& solution) { this->__post_apply_action(solution); };
+
+	__solution_storage->setGraphFrozen(true);
+	try
+	{
+		threadPool.run(solutions.size(), [this, &solutions, &apply](size_t index)
+		{
+			this->__solution_storage->applyWithFrozenGraph(*solutions[index], apply);
+		});
+	}
+	catch (...)
+	{
+		__solution_storage->setGraphFrozen(false);
+		throw;
+	}
+	__solution_storage->setGraphFrozen(false);
+}
+
 bool NativeResolverImpl::__makes_sense_to_modify_package(const Solution& solution,
 		const dg::Element* candidateElementPtr, const dg::Element* brokenElementPtr,
 		bool debugging)
@@ -787,13 +891,58 @@ Resolver::UserAnswer::Type NativeResolverImpl::__propose_solution(
 	return userAnswer;
 }
 
-void NativeResolverImpl::__generate_possible_actions(vector< unique_ptr< Action > >* possibleActionsPtr,
+// returns the number of actions discarded because they would lead to known
+// dead ends
+size_t NativeResolverImpl::__generate_possible_actions(vector< unique_ptr< Action > >* possibleActionsPtr,
 		const Solution& solution, const dg::Element* versionElementPtr,
 		const dg::Element* brokenElementPtr, bool debugging)
 {
-	__add_actions_to_fix_dependency(*possibleActionsPtr, solution, brokenElementPtr);
-	__add_actions_to_modify_package_entry(*possibleActionsPtr, solution,
+	auto& possibleActions = *possibleActionsPtr;
+	__add_actions_to_fix_dependency(possibleActions, solution, brokenElementPtr);
+	__add_actions_to_modify_package_entry(possibleActions, solution,
 			versionElementPtr, brokenElementPtr, debugging);
+
+	if (possibleActions.empty())
+	{
+		// a dead end; if it doesn't depend on non-sticked entries, any other
+		// solution which sticks the same elements will end up here as well
+		PackageEntry::IntroducedBy introducedBy;
+		introducedBy.versionElementPtr = versionElementPtr;
+		introducedBy.brokenElementPtr = brokenElementPtr;
+		auto nogood = NogoodSet::getNogood(*__solution_storage, solution, introducedBy);
+		if (!nogood.empty() && __nogoods.add(std::move(nogood)) && debugging)
+		{
+			__mydebug_wrapper(solution, "learned a conflict, %zu known", __nogoods.size());
+		}
+		return 0;
+	}
+
+	size_t discardedCount = 0;
+	auto newEnd = std::remove_if(possibleActions.begin(), possibleActions.end(),
+			[this, &solution, &discardedCount, debugging](const unique_ptr< Action >& action)
+			{
+				auto nogoodPtr = __nogoods.getCompleted(solution,
+						action->oldElementPtr, action->newElementPtr);
+				if (!nogoodPtr)
+				{
+					return false;
+				}
+				if (debugging)
+				{
+					vector< string > elementStrings;
+					FORIT(elementPtrIt, *nogoodPtr)
+					{
+						elementStrings.push_back((*elementPtrIt)->toString());
+					}
+					__mydebug_wrapper(solution, "discarded: '%s' -> '%s': known conflict: %s",
+							action->oldElementPtr ? action->oldElementPtr->toString() : "",
+							action->newElementPtr->toString(), join(", ", elementStrings));
+				}
+				++discardedCount;
+				return true;
+			});
+	possibleActions.erase(newEnd, possibleActions.end());
+	return discardedCount;
 }
 
 void NativeResolverImpl::__final_verify_solution(const Solution& solution)
@@ -860,15 +1009,20 @@ BrokenPairType __get_broken_pair(const SolutionStorage& solutionStorage,
 		return left.elementPtr->id < right.elementPtr->id;
 	};
 
-	const auto& brokenSuccessors = solution.getBrokenSuccessors();
-	auto bestBrokenSuccessorIt = std::max_element(
-			brokenSuccessors.begin(), brokenSuccessors.end(), compareBrokenSuccessors);
-	if (bestBrokenSuccessorIt == brokenSuccessors.end())
+	const BrokenSuccessor* bestBrokenSuccessorPtr = NULL;
+	solution.forEachBrokenSuccessor([&bestBrokenSuccessorPtr, &compareBrokenSuccessors](const BrokenSuccessor& brokenSuccessor)
+	{
+		if (!bestBrokenSuccessorPtr || compareBrokenSuccessors(*bestBrokenSuccessorPtr, brokenSuccessor))
+		{
+			bestBrokenSuccessorPtr = &brokenSuccessor;
+		}
+	});
+	if (!bestBrokenSuccessorPtr)
 	{
 		return BrokenPairType{ NULL, { NULL, 0 } };
 	}
-	BrokenPairType result(NULL, *bestBrokenSuccessorIt);
-	for (auto reverseDependencyPtr: solutionStorage.getPredecessorElements(bestBrokenSuccessorIt->elementPtr))
+	BrokenPairType result(NULL, *bestBrokenSuccessorPtr);
+	for (auto reverseDependencyPtr: solutionStorage.getPredecessorElements(bestBrokenSuccessorPtr->elementPtr))
 	{
 		if (solution.getPackageEntry(reverseDependencyPtr))
 		{
@@ -881,7 +1035,7 @@ BrokenPairType __get_broken_pair(const SolutionStorage& solutionStorage,
 	if (!result.first)
 	{
 		fatal2i("__get_broken_pair: no existing in the solution predecessors for the broken successor '%s'",
-				bestBrokenSuccessorIt->elementPtr->toString());
+				bestBrokenSuccessorPtr->elementPtr->toString());
 	}
 
 	return result;
@@ -896,6 +1050,15 @@ bool NativeResolverImpl::resolve(Resolver::CallbackType callback)
 	const size_t maxSolutionCount = __config->getInteger("cupt::resolver::max-solution-count");
 	bool thereWereSolutionsDropped = false;
 
+	unique_ptr< threadpool::ThreadPool > threadPool;
+	{
+		auto threadCount = __config->getInteger("cupt::resolver::threads");
+		if (threadCount != 1)
+		{
+			threadPool.reset(new threadpool::ThreadPool(threadCount));
+		}
+	}
+
 	if (debugging)
 	{
 		debug2("started resolving");
@@ -904,12 +1067,14 @@ bool NativeResolverImpl::resolve(Resolver::CallbackType callback)
 
 	__any_solution_was_found = false;
 	__decision_fail_tree.clear();
+	__nogoods.clear();
 
 	shared_ptr< Solution > initialSolution(new Solution);
 	__solution_storage.reset(new SolutionStorage(*__config, *__cache));
 	__solution_storage->prepareForResolving(*initialSolution, __old_packages, __initial_packages);
 
-	SolutionContainer solutions = { initialSolution };
+	SolutionContainer solutions;
+	solutions.insert(initialSolution);
 
 	// for each package entry 'count' will contain the number of failures
 	// during processing these packages
@@ -921,17 +1086,20 @@ bool NativeResolverImpl::resolve(Resolver::CallbackType callback)
 	{
 		vector< unique_ptr< Action > > possibleActions;
 
-		// choosing the solution to process
-		shared_ptr< Solution > currentSolution;
+		if (threadPool)
 		{
-			auto currentSolutionIt = solutionChooser(solutions);
-			currentSolution = *currentSolutionIt;
-			solutions.erase(currentSolutionIt);
+			auto pendingSolutions = __get_best_pending_solutions(solutions, threadPool->getThreadCount());
+			if (pendingSolutions.size() > 1)
+			{
+				__post_apply_actions_concurrently(*threadPool, pendingSolutions);
+			}
 		}
 
+		// choosing the solution to process
+		shared_ptr< Solution > currentSolution = solutions.extract(solutionChooser(solutions));
+
 		if (currentSolution->pendingAction)
 		{
-			currentSolution->prepare();
 			__post_apply_action(*currentSolution);
 		}
 
@@ -958,15 +1126,16 @@ bool NativeResolverImpl::resolve(Resolver::CallbackType callback)
 						brokenSuccessor.elementPtr->getTypePriority(), brokenSuccessor.priority,
 						versionElementPtr->toString(), brokenSuccessor.elementPtr->toString());
 			}
-			__generate_possible_actions(&possibleActions, *currentSolution,
-					versionElementPtr, brokenSuccessor.elementPtr, debugging);
+			auto discardedActionCount = __generate_possible_actions(&possibleActions,
+					*currentSolution, versionElementPtr, brokenSuccessor.elementPtr, debugging);
 
 			{
 				PackageEntry::IntroducedBy ourIntroducedBy;
 				ourIntroducedBy.versionElementPtr = versionElementPtr;
 				ourIntroducedBy.brokenElementPtr = brokenSuccessor.elementPtr;
 
-				if (possibleActions.empty() && !__any_solution_was_found)
+				// the discarded actions were explained by earlier fails already
+				if (possibleActions.empty() && !discardedActionCount && !__any_solution_was_found)
 				{
 					__decision_fail_tree.addFailedSolution(*__solution_storage,
 							*currentSolution, ourIntroducedBy);
@@ -1004,12 +1173,12 @@ bool NativeResolverImpl::resolve(Resolver::CallbackType callback)
 
 			// resolver can refuse the solution
 			solutions.insert(currentSolution);
-			auto newSelectedSolutionIt = solutionChooser(solutions);
-			if (*newSelectedSolutionIt != currentSolution)
+			auto newSelectedSolutionPosition = solutionChooser(solutions);
+			if (solutions.get(newSelectedSolutionPosition) != currentSolution)
 			{
 				continue; // ok, process other solution
 			}
-			solutions.erase(newSelectedSolutionIt);
+			solutions.extract(newSelectedSolutionPosition);
 
 			// clean up automatically installed by resolver and now unneeded packages
 			if (!__clean_automatically_installed(*currentSolution))
@@ -27,7 +27,9 @@
 #include <internal/nativeresolver/solution.hpp>
 #include <internal/nativeresolver/score.hpp>
 #include <internal/nativeresolver/decisionfailtree.hpp>
+#include <internal/nativeresolver/nogoods.hpp>
 #include <internal/nativeresolver/autoremovalpossibility.hpp>
+#include <internal/threadpool.hpp>
 
 namespace cupt {
 namespace internal {
@@ -59,6 +61,7 @@ class NativeResolverImpl
 	RelationLine __unsatisfy_relation_expressions;
 
 	DecisionFailTree __decision_fail_tree;
+	NogoodSet __nogoods;
 	bool __any_solution_was_found;
 
 	void __import_installed_versions();
@@ -78,6 +81,7 @@ class NativeResolverImpl
 			const shared_ptr< Solution >&, vector< unique_ptr< Action > >&);
 
 	void __post_apply_action(Solution&);
+	void __post_apply_actions_concurrently(threadpool::ThreadPool&, const vector< Solution* >&);
 	void __final_verify_solution(const Solution&);
 
 	bool __makes_sense_to_modify_package(const Solution&, const dg::Element*,
@@ -91,7 +95,7 @@ class NativeResolverImpl
 	Resolver::UserAnswer::Type __propose_solution(
 			const Solution&, Resolver::CallbackType, bool);
 
-	void __generate_possible_actions(vector< unique_ptr< Action > >*, const Solution&,
+	size_t __generate_possible_actions(vector< unique_ptr< Action > >*, const Solution&,
 			const dg::Element*, const dg::Element*, bool);
 
 	static const string __dummy_package_name;
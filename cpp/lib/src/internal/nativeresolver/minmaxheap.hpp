@@ -0,0 +1,230 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#ifndef CUPT_INTERNAL_NATIVERESOLVER_MINMAXHEAP_SEEN
+#define CUPT_INTERNAL_NATIVERESOLVER_MINMAXHEAP_SEEN
+
+#include <algorithm>
+
+#include <cupt/common.hpp>
+
+namespace cupt {
+namespace internal {
+
+// a double-ended priority queue over an array: the elements on even levels
+// of the tree are not greater than their descendants, the elements on odd
+// levels are not less than them, so both the least and the greatest
+// elements are found in O(1) and inserted or removed in O(log n)
+template < typename T, typename Less >
+class MinMaxHeap
+{
+	vector< T > __elements;
+	Less __less;
+
+	static bool __is_min_level(size_t index)
+	{
+		// the level of an index is floor(log2(index+1))
+		return !((sizeof(unsigned long long) * 8 - 1 - __builtin_clzll(index + 1)) & 1);
+	}
+	// should the element 'left' be higher than the element 'right' if
+	// 'left' was on a min or on a max level
+	bool __is_higher(bool minLevel, size_t left, size_t right) const
+	{
+		return minLevel ? __less(__elements[left], __elements[right]) :
+				__less(__elements[right], __elements[left]);
+	}
+
+	void __bubble_up_by_grandparents(size_t index, bool minLevel)
+	{
+		while (index > 2)
+		{
+			size_t grandparent = (index - 3) / 4;
+			if (!__is_higher(minLevel, index, grandparent))
+			{
+				break;
+			}
+			std::swap(__elements[index], __elements[grandparent]);
+			index = grandparent;
+		}
+	}
+
+	void __bubble_up(size_t index)
+	{
+		bool minLevel = __is_min_level(index);
+		if (index)
+		{
+			size_t parent = (index - 1) / 2;
+			if (__is_higher(!minLevel, index, parent))
+			{
+				std::swap(__elements[index], __elements[parent]);
+				index = parent;
+				minLevel = !minLevel;
+			}
+		}
+		__bubble_up_by_grandparents(index, minLevel);
+	}
+
+	void __trickle_down(size_t index)
+	{
+		const bool minLevel = __is_min_level(index);
+		const size_t size = __elements.size();
+		while (true)
+		{
+			size_t firstChild = 2 * index + 1;
+			if (firstChild >= size)
+			{
+				return;
+			}
+
+			// the highest one among children and grandchildren
+			size_t highest = firstChild;
+			if (firstChild + 1 < size && __is_higher(minLevel, firstChild + 1, highest))
+			{
+				highest = firstChild + 1;
+			}
+			size_t firstGrandchild = 2 * firstChild + 1;
+			for (size_t grandchild = firstGrandchild;
+					grandchild < std::min(firstGrandchild + 4, size); ++grandchild)
+			{
+				if (__is_higher(minLevel, grandchild, highest))
+				{
+					highest = grandchild;
+				}
+			}
+
+			if (!__is_higher(minLevel, highest, index))
+			{
+				return;
+			}
+			std::swap(__elements[highest], __elements[index]);
+			if (highest < firstGrandchild)
+			{
+				return; // a child, it has no descendants to check
+			}
+
+			size_t parent = (highest - 1) / 2;
+			if (__is_higher(!minLevel, highest, parent))
+			{
+				std::swap(__elements[highest], __elements[parent]);
+			}
+			index = highest;
+		}
+	}
+
+	size_t __get_greatest_index() const
+	{
+		if (__elements.size() <= 2)
+		{
+			return __elements.size() - 1;
+		}
+		return __less(__elements[1], __elements[2]) ? 2 : 1;
+	}
+
+	T __extract(size_t index)
+	{
+		T result = std::move(__elements[index]);
+		if (index + 1 != __elements.size())
+		{
+			__elements[index] = std::move(__elements.back());
+			__elements.pop_back();
+			__trickle_down(index);
+		}
+		else
+		{
+			__elements.pop_back();
+		}
+		return result;
+	}
+ public:
+	MinMaxHeap(const Less& less = Less())
+		: __less(less)
+	{}
+
+	bool empty() const
+	{
+		return __elements.empty();
+	}
+	size_t size() const
+	{
+		return __elements.size();
+	}
+
+	void push(const T& element)
+	{
+		__elements.push_back(element);
+		__bubble_up(__elements.size() - 1);
+	}
+
+	// the heap should not be empty
+	const T& getLeast() const
+	{
+		return __elements[0];
+	}
+	const T& getGreatest() const
+	{
+		return __elements[__get_greatest_index()];
+	}
+	T extractLeast()
+	{
+		return __extract(0);
+	}
+	T extractGreatest()
+	{
+		return __extract(__get_greatest_index());
+	}
+
+	// up to 'count' greatest elements, the greatest first, in O(count^2)
+	vector< const T* > getGreatest(size_t count) const
+	{
+		// every element which isn't a candidate yet has an ancestor on a max
+		// level among the candidates, which is not less than it
+		vector< const T* > result;
+		vector< size_t > candidates;
+		auto addCandidates = [this, &candidates](size_t begin, size_t end)
+		{
+			for (size_t index = begin; index < std::min(end, __elements.size()); ++index)
+			{
+				candidates.push_back(index);
+			}
+		};
+		addCandidates(0, 3);
+		while (result.size() < count && !candidates.empty())
+		{
+			auto greatestIt = std::max_element(candidates.begin(), candidates.end(),
+					[this](size_t left, size_t right)
+					{
+						return this->__less(this->__elements[left], this->__elements[right]);
+					});
+			size_t index = *greatestIt;
+			candidates.erase(greatestIt);
+			result.push_back(&__elements[index]);
+
+			if (index && !__is_min_level(index))
+			{
+				addCandidates(2 * index + 1, 2 * index + 3); // children
+				addCandidates(4 * index + 3, 4 * index + 7); // grandchildren
+			}
+		}
+		return result;
+	}
+};
+
+}
+}
+
+#endif
+
@@ -0,0 +1,131 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#include <algorithm>
+
+#include <internal/nativeresolver/nogoods.hpp>
+
+namespace cupt {
+namespace internal {
+
+bool NogoodSet::add(vector< const dg::Element* >&& nogood)
+{
+	std::sort(nogood.begin(), nogood.end(),
+			[](const dg::Element* left, const dg::Element* right)
+			{
+				return left->id < right->id;
+			});
+	if (!__known_nogoods.insert(nogood).second)
+	{
+		return false;
+	}
+
+	size_t index = __nogoods.size();
+	FORIT(elementPtrIt, nogood)
+	{
+		__nogood_indexes[*elementPtrIt].push_back(index);
+	}
+	__nogoods.push_back(std::move(nogood));
+	return true;
+}
+
+const vector< const dg::Element* >* NogoodSet::getCompleted(const Solution& solution,
+		const dg::Element* oldElementPtr, const dg::Element* newElementPtr) const
+{
+	auto indexesIt = __nogood_indexes.find(newElementPtr);
+	if (indexesIt == __nogood_indexes.end())
+	{
+		return NULL;
+	}
+
+	auto isStickedAfterwards = [&solution, oldElementPtr, newElementPtr](const dg::Element* elementPtr)
+	{
+		if (elementPtr == newElementPtr)
+		{
+			return true;
+		}
+		if (elementPtr == oldElementPtr)
+		{
+			return false;
+		}
+		auto packageEntryPtr = solution.getPackageEntry(elementPtr);
+		return packageEntryPtr && packageEntryPtr->sticked;
+	};
+	FORIT(indexIt, indexesIt->second)
+	{
+		const auto& nogood = __nogoods[*indexIt];
+		if (std::all_of(nogood.begin(), nogood.end(), isStickedAfterwards))
+		{
+			return &nogood;
+		}
+	}
+	return NULL;
+}
+
+vector< const dg::Element* > NogoodSet::getNogood(const SolutionStorage& solutionStorage,
+		const Solution& solution, const PackageEntry::IntroducedBy& introducedBy)
+{
+	vector< const dg::Element* > result;
+	auto addSticked = [&solution, &result](const dg::Element* elementPtr)
+	{
+		auto packageEntryPtr = solution.getPackageEntry(elementPtr);
+		if (!packageEntryPtr || !packageEntryPtr->sticked)
+		{
+			return false;
+		}
+		if (std::find(result.begin(), result.end(), elementPtr) == result.end())
+		{
+			result.push_back(elementPtr);
+		}
+		return true;
+	};
+
+	// the version can't be changed, and every successor of the broken
+	// element conflicts with an element which can't be changed either
+	if (!addSticked(introducedBy.versionElementPtr))
+	{
+		return {};
+	}
+	const GraphCessorListType& successors =
+			solutionStorage.getSuccessorElements(introducedBy.brokenElementPtr);
+	FORIT(successorIt, successors)
+	{
+		const dg::Element* conflictingElementPtr;
+		if (solutionStorage.simulateSetPackageEntry(solution, *successorIt, &conflictingElementPtr) ||
+				!addSticked(conflictingElementPtr))
+		{
+			return {};
+		}
+	}
+
+	return result;
+}
+
+size_t NogoodSet::size() const
+{
+	return __nogoods.size();
+}
+
+void NogoodSet::clear()
+{
+	__nogoods.clear();
+	__known_nogoods.clear();
+	__nogood_indexes.clear();
+}
+
+}
+}
@@ -0,0 +1,56 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#ifndef CUPT_INTERNAL_NATIVERESOLVER_NOGOODS_SEEN
+#define CUPT_INTERNAL_NATIVERESOLVER_NOGOODS_SEEN
+
+#include <set>
+#include <unordered_map>
+
+#include <internal/nativeresolver/solution.hpp>
+
+namespace cupt {
+namespace internal {
+
+// sets of elements which cannot be sticked together in any finished
+// solution, learned from the failed ones
+class NogoodSet
+{
+	vector< vector< const dg::Element* > > __nogoods;
+	std::set< vector< const dg::Element* > > __known_nogoods;
+	std::unordered_map< const dg::Element*, vector< size_t > > __nogood_indexes;
+ public:
+	// returns false if the nogood is known already
+	bool add(vector< const dg::Element* >&&);
+	// would sticking 'newElementPtr' instead of 'oldElementPtr' in 'solution'
+	// complete a nogood
+	const vector< const dg::Element* >* getCompleted(const Solution& solution,
+			const dg::Element* oldElementPtr, const dg::Element* newElementPtr) const;
+	size_t size() const;
+	void clear();
+
+	// the sticked elements which, when all of them are sticked in any
+	// solution, leave no way to fix 'introducedBy' there; empty if the
+	// failure of 'solution' depends also on non-sticked entries
+	static vector< const dg::Element* > getNogood(const SolutionStorage&,
+			const Solution&, const PackageEntry::IntroducedBy&);
+};
+
+}
+}
+
+#endif
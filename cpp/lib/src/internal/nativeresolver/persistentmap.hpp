@@ -0,0 +1,406 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#ifndef CUPT_INTERNAL_NATIVERESOLVER_PERSISTENTMAP_SEEN
+#define CUPT_INTERNAL_NATIVERESOLVER_PERSISTENTMAP_SEEN
+
+#include <cstdint>
+#include <atomic>
+#include <new>
+
+#include <cupt/common.hpp>
+
+namespace cupt {
+namespace internal {
+
+// a map from 32-bit keys as a hash array mapped trie: each level of the trie
+// consumes 5 bits of the key, starting from the lowest ones, and a branch
+// stores only its present children, indexed by the popcount of a bitmap
+//
+// a leaf always hangs on the highest level where no other key shares its
+// bits, so the shape of the trie depends only on the set of keys
+//
+// the nodes are shared between copies of the map, so a copy is O(1) and a
+// change copies only the shared nodes on the path to the key, O(log32 n) of
+// them; reference counters are atomic, so different copies may be changed
+// from different threads
+//
+// keys are expected to be dense (like vertex identifiers), so they are used
+// as they are, without hashing
+template < typename Value >
+class PersistentMap
+{
+	struct Node
+	{
+		std::atomic< size_t > referenceCount;
+		bool isLeaf;
+
+		explicit Node(bool isLeaf_)
+			: referenceCount(1), isLeaf(isLeaf_)
+		{}
+	};
+	struct Leaf: public Node
+	{
+		uint32_t key;
+		Value value;
+
+		template < typename... Args >
+		Leaf(uint32_t key_, Args&&... args)
+			: Node(true), key(key_), value(std::forward< Args >(args)...)
+		{}
+	};
+	struct Branch: public Node
+	{
+		uint32_t bitmap;
+		Node* children[1]; // actually, popcount(bitmap) of them
+
+		Branch()
+			: Node(false)
+		{}
+		size_t getChildCount() const
+		{
+			return __popcount(bitmap);
+		}
+		Node*& getChild(uint32_t bit)
+		{
+			return children[__popcount(bitmap & (bit - 1))];
+		}
+	};
+
+	static const size_t __bits_per_level = 5;
+
+	Node* __root;
+	size_t __size;
+
+	// without the hardware instruction, __builtin_popcount is a library call
+	static size_t __popcount(uint32_t x)
+	{
+		x = x - ((x >> 1) & 0x55555555);
+		x = (x & 0x33333333) + ((x >> 2) & 0x33333333);
+		x = (x + (x >> 4)) & 0x0f0f0f0f;
+		return (x * 0x01010101) >> 24;
+	}
+	static uint32_t __get_bit(uint32_t key, size_t shift)
+	{
+		return uint32_t(1) << ((key >> shift) & 31);
+	}
+
+	// the children are to be filled by the caller
+	static Branch* __new_branch(uint32_t bitmap)
+	{
+		size_t childCount = __popcount(bitmap);
+		void* memory = operator new(sizeof(Branch) + (childCount - 1) * sizeof(Node*));
+		auto result = new (memory) Branch;
+		result->bitmap = bitmap;
+		return result;
+	}
+	// frees the branch itself, the references to children are to be taken
+	// over by the caller
+	static void __delete_branch_shell(Branch* branch)
+	{
+		branch->~Branch();
+		operator delete(branch);
+	}
+
+	static Node* __retain(Node* node)
+	{
+		++node->referenceCount;
+		return node;
+	}
+	static void __release(Node* node)
+	{
+		if (--node->referenceCount)
+		{
+			return;
+		}
+		if (node->isLeaf)
+		{
+			delete static_cast< Leaf* >(node);
+		}
+		else
+		{
+			auto branch = static_cast< Branch* >(node);
+			for (size_t i = 0; i < branch->getChildCount(); ++i)
+			{
+				__release(branch->children[i]);
+			}
+			__delete_branch_shell(branch);
+		}
+	}
+
+	// nodes referenced only once belong to this map alone and are changed in
+	// place, the shared ones are copied first
+	static Branch* __make_exclusive(Node*& slot)
+	{
+		auto branch = static_cast< Branch* >(slot);
+		if (branch->referenceCount == 1)
+		{
+			return branch;
+		}
+		auto result = __new_branch(branch->bitmap);
+		for (size_t i = 0; i < result->getChildCount(); ++i)
+		{
+			result->children[i] = __retain(branch->children[i]);
+		}
+		__release(branch);
+		slot = result;
+		return result;
+	}
+
+	// moves the children of the exclusive 'source' to a branch with the new
+	// bitmap; the children on the dropped bits are discarded, the ones on the
+	// added bits are to be filled by the caller
+	static Branch* __rebuild(Branch* source, uint32_t bitmap)
+	{
+		auto result = __new_branch(bitmap);
+		for (uint32_t bits = bitmap & source->bitmap; bits; bits &= bits - 1)
+		{
+			uint32_t bit = bits & -bits;
+			result->getChild(bit) = source->getChild(bit);
+		}
+		__delete_branch_shell(source);
+		return result;
+	}
+
+	// the trie containing both leaves, starting from the level 'shift'
+	static Node* __merge(Leaf* first, Leaf* second, size_t shift)
+	{
+		uint32_t firstBit = __get_bit(first->key, shift);
+		uint32_t secondBit = __get_bit(second->key, shift);
+		if (firstBit == secondBit)
+		{
+			auto result = __new_branch(firstBit);
+			result->children[0] = __merge(first, second, shift + __bits_per_level);
+			return result;
+		}
+		auto result = __new_branch(firstBit | secondBit);
+		result->getChild(firstBit) = first;
+		result->getChild(secondBit) = second;
+		return result;
+	}
+
+	// puts 'leaf' into the trie in 'slot', the reference to 'leaf' is consumed
+	static void __set(Node*& slot, Leaf* leaf, size_t shift, bool& isAdded)
+	{
+		if (slot->isLeaf)
+		{
+			auto oldLeaf = static_cast< Leaf* >(slot);
+			if (oldLeaf->key == leaf->key)
+			{
+				__release(oldLeaf);
+				slot = leaf;
+			}
+			else
+			{
+				isAdded = true;
+				slot = __merge(oldLeaf, leaf, shift);
+			}
+			return;
+		}
+
+		auto branch = __make_exclusive(slot);
+		uint32_t bit = __get_bit(leaf->key, shift);
+		if (branch->bitmap & bit)
+		{
+			__set(branch->getChild(bit), leaf, shift + __bits_per_level, isAdded);
+		}
+		else
+		{
+			isAdded = true;
+			branch = __rebuild(branch, branch->bitmap | bit);
+			branch->getChild(bit) = leaf;
+			slot = branch;
+		}
+	}
+
+	// removes 'key', which should be present, from the trie in 'slot'; 'slot'
+	// becomes NULL if nothing is left
+	static void __erase(Node*& slot, uint32_t key, size_t shift)
+	{
+		if (slot->isLeaf)
+		{
+			__release(slot);
+			slot = NULL;
+			return;
+		}
+
+		auto branch = __make_exclusive(slot);
+		uint32_t bit = __get_bit(key, shift);
+		Node*& childSlot = branch->getChild(bit);
+		__erase(childSlot, key, shift + __bits_per_level);
+		Node* child = childSlot;
+		if (child)
+		{
+			if (branch->getChildCount() == 1 && child->isLeaf)
+			{
+				// the last leaf of the subtrie moves up
+				__delete_branch_shell(branch);
+				slot = child;
+			}
+			return;
+		}
+
+		if (branch->getChildCount() == 1)
+		{
+			__delete_branch_shell(branch);
+			slot = NULL;
+			return;
+		}
+		branch = __rebuild(branch, branch->bitmap & ~bit);
+		if (branch->getChildCount() == 1 && branch->children[0]->isLeaf)
+		{
+			child = branch->children[0];
+			__delete_branch_shell(branch);
+			slot = child;
+		}
+		else
+		{
+			slot = branch;
+		}
+	}
+
+	template < typename Callback >
+	static void __for_each(const Node* node, const Callback& callback)
+	{
+		if (node->isLeaf)
+		{
+			auto leaf = static_cast< const Leaf* >(node);
+			callback(leaf->key, leaf->value);
+		}
+		else
+		{
+			auto branch = static_cast< const Branch* >(node);
+			for (size_t i = 0; i < branch->getChildCount(); ++i)
+			{
+				__for_each(branch->children[i], callback);
+			}
+		}
+	}
+ public:
+	PersistentMap()
+		: __root(NULL), __size(0)
+	{}
+	PersistentMap(const PersistentMap& other)
+		: __root(other.__root ? __retain(other.__root) : NULL), __size(other.__size)
+	{}
+	PersistentMap(PersistentMap&& other)
+		: __root(other.__root), __size(other.__size)
+	{
+		other.__root = NULL;
+		other.__size = 0;
+	}
+	PersistentMap& operator=(const PersistentMap& other)
+	{
+		PersistentMap copy(other);
+		swap(copy);
+		return *this;
+	}
+	PersistentMap& operator=(PersistentMap&& other)
+	{
+		swap(other);
+		return *this;
+	}
+	~PersistentMap()
+	{
+		if (__root)
+		{
+			__release(__root);
+		}
+	}
+
+	void swap(PersistentMap& other)
+	{
+		std::swap(__root, other.__root);
+		std::swap(__size, other.__size);
+	}
+
+	size_t size() const
+	{
+		return __size;
+	}
+
+	const Value* find(uint32_t key) const
+	{
+		const Node* node = __root;
+		size_t shift = 0;
+		while (node)
+		{
+			if (node->isLeaf)
+			{
+				auto leaf = static_cast< const Leaf* >(node);
+				return (leaf->key == key) ? &leaf->value : NULL;
+			}
+			auto branch = static_cast< const Branch* >(node);
+			uint32_t bit = __get_bit(key, shift);
+			if (!(branch->bitmap & bit))
+			{
+				return NULL;
+			}
+			node = branch->children[__popcount(branch->bitmap & (bit - 1))];
+			shift += __bits_per_level;
+		}
+		return NULL;
+	}
+
+	// inserts or replaces
+	template < typename... Args >
+	void set(uint32_t key, Args&&... args)
+	{
+		auto leaf = new Leaf(key, std::forward< Args >(args)...);
+		if (!__root)
+		{
+			__root = leaf;
+			__size = 1;
+			return;
+		}
+		bool isAdded = false;
+		__set(__root, leaf, 0, isAdded);
+		if (isAdded)
+		{
+			++__size;
+		}
+	}
+
+	// returns false if there was no such key
+	bool erase(uint32_t key)
+	{
+		if (!find(key))
+		{
+			return false;
+		}
+		__erase(__root, key, 0);
+		--__size;
+		return true;
+	}
+
+	// calls callback(key, value) for all elements, in an order which depends
+	// only on the set of keys
+	template < typename Callback >
+	void forEach(const Callback& callback) const
+	{
+		if (__root)
+		{
+			__for_each(__root, callback);
+		}
+	}
+};
+
+}
+}
+
+#endif
+
@@ -23,6 +23,7 @@
 #include <cupt/cache/binarypackage.hpp>
 
 #include <internal/nativeresolver/score.hpp>
+#include <internal/versionkey.hpp>
 
 namespace cupt {
 namespace internal {
@@ -106,8 +107,8 @@ ScoreChange ScoreManager::getVersionScoreChange(const shared_ptr< const BinaryVe
 	}
 	else
 	{
-		scoreType = compareVersionStrings(originalVersion->versionString,
-				supposedVersion->versionString) < 0 ? ScoreChange::SubScore::Upgrade : ScoreChange::SubScore::Downgrade;
+		scoreType = versionkey::compare(*originalVersion, *supposedVersion) < 0 ?
+				ScoreChange::SubScore::Upgrade : ScoreChange::SubScore::Downgrade;
 	}
 
 	scoreChange.__subscores[ScoreChange::SubScore::Version] = value;
@@ -38,102 +38,12 @@ bool PackageEntry::isModificationAllowed(const dg::Element* elementPtr) const
 	return (findResult == rejectedConflictors.end());
 }
 
-template < class data_t, class KeyGetter >
-class VectorBasedMap
-{
- public:
-	typedef const dg::Element* key_t;
-	typedef data_t value_type; // for set_union
-	typedef vector< data_t > container_t;
-	typedef data_t* iterator_t;
-	typedef const data_t* const_iterator_t;
- private:
-	container_t __container;
-	typename container_t::iterator __position_to_iterator(const_iterator_t position)
-	{
-		return static_cast< typename container_t::iterator >(const_cast< iterator_t >(position));
-	}
-	struct __comparator
-	{
-		bool operator()(const data_t& data, const key_t& key) const
-		{
-			return KeyGetter()(data) < key;
-		}
-	};
- public:
-	size_t size() const { return __container.size(); }
-	void reserve(size_t size) { __container.reserve(size); }
-	const_iterator_t begin() const { return &*__container.begin(); }
-	const_iterator_t end() const { return &*__container.end(); }
-	const_iterator_t lower_bound(const key_t& key) const
-	{
-		return std::lower_bound(begin(), end(), key, __comparator());
-	}
-	iterator_t lower_bound(const key_t& key)
-	{
-		return const_cast< iterator_t >(((const VectorBasedMap*)this)->lower_bound(key));
-	}
-	const_iterator_t find(const key_t& key) const
-	{
-		auto result = lower_bound(key);
-		if (result != end() && KeyGetter()(*result) != key)
-		{
-			result = end();
-		}
-		return result;
-	}
-	// this insert() is called only for unexisting elements
-	iterator_t insert(const_iterator_t position, data_t&& data)
-	{
-		auto distance = position - begin();
-		__container.insert(__position_to_iterator(position), std::move(data));
-		return const_cast< iterator_t >(begin()) + distance;
-	}
-	void erase(const_iterator_t position)
-	{
-		__container.erase(__position_to_iterator(position));
-	}
-	void push_back(const data_t& data)
-	{
-		__container.push_back(data);
-	}
-	const container_t& getContainer() const
-	{
-		return __container;
-	}
-};
-
-typedef shared_ptr< const PackageEntry > SPPE;
-
-struct PackageEntryMapKeyGetter
-{
-	const dg::Element* operator()(const pair< const dg::Element*, SPPE >& data)
-	{ return data.first; }
-};
-class PackageEntryMap: public VectorBasedMap<
-		pair< const dg::Element*, SPPE >, PackageEntryMapKeyGetter >
-{
- public:
-	mutable size_t forkedCount;
-
-	PackageEntryMap()
-		: forkedCount(0)
-	{}
-};
-
-struct BrokenSuccessorMapKeyGetter
-{
-	const dg::Element* operator()(const BrokenSuccessor& data) { return data.elementPtr; }
-};
-class BrokenSuccessorMap: public VectorBasedMap< BrokenSuccessor, BrokenSuccessorMapKeyGetter >
-{};
-
 SolutionStorage::Change::Change(size_t parentSolutionId_)
 	: parentSolutionId(parentSolutionId_)
 {}
 
 SolutionStorage::SolutionStorage(const Config& config, const Cache& cache)
-	: __next_free_id(1), __dependency_graph(config, cache)
+	: __next_free_id(1), __arena(new arena::Arena), __dependency_graph(config, cache)
 {}
 
 size_t SolutionStorage::__get_new_solution_id(const Solution& parent)
@@ -150,15 +60,14 @@ shared_ptr< Solution > SolutionStorage::fakeCloneSolution(const shared_ptr< Solu
 
 shared_ptr< Solution > SolutionStorage::cloneSolution(const shared_ptr< Solution >& source)
 {
-	auto cloned = std::make_shared< Solution >();
+	auto cloned = arena::makeShared< Solution >(__arena.get());
 	cloned->score = source->score;
 	cloned->level = source->level;
 	cloned->id = __get_new_solution_id(*source);
 	cloned->finished = false;
 
-	cloned->__parent = source;
-
-	// other part should be done by calling prepare outside
+	cloned->__entries = source->__entries;
+	cloned->__broken_successors = source->__broken_successors;
 
 	return cloned;
 }
@@ -241,7 +150,7 @@ void SolutionStorage::__update_broken_successors(Solution& solution,
 		return;
 	}
 
-	auto& bss = *solution.__broken_successors;
+	auto& bss = solution.__broken_successors;
 
 	auto reverseDependencyExists = [this, &solution](const dg::Element* elementPtr)
 	{
@@ -268,13 +177,9 @@ void SolutionStorage::__update_broken_successors(Solution& solution,
 	{
 		if (isPresent(successorsOfNew, successorPtr)) continue;
 
-		auto it = bss.find(successorPtr);
-		if (it != bss.end())
+		if (bss.find(successorPtr->id) && !reverseDependencyExists(successorPtr))
 		{
-			if (!reverseDependencyExists(successorPtr))
-			{
-				bss.erase(it);
-			}
+			bss.erase(successorPtr->id);
 		}
 	}
 	// check direct dependencies of the new element
@@ -282,17 +187,17 @@ void SolutionStorage::__update_broken_successors(Solution& solution,
 	{
 		if (isPresent(successorsOfOld, successorPtr)) continue;
 
-		auto it = bss.lower_bound(successorPtr);
-		if (it == bss.end() || it->elementPtr != successorPtr)
+		auto brokenSuccessorPtr = bss.find(successorPtr->id);
+		if (!brokenSuccessorPtr)
 		{
 			if (!verifyElement(solution, successorPtr))
 			{
-				bss.insert(it, BrokenSuccessor { successorPtr, priority });
+				bss.set(successorPtr->id, BrokenSuccessor { successorPtr, priority });
 			}
 		}
-		else
+		else if (brokenSuccessorPtr->priority < priority)
 		{
-			it->priority = std::max(it->priority, priority);
+			bss.set(successorPtr->id, BrokenSuccessor { successorPtr, priority });
 		}
 	}
 
@@ -311,7 +216,7 @@ void SolutionStorage::__update_broken_successors(Solution& solution,
 				// here we assume brokenSuccessors didn't
 				// contain predecessorElementPtr, since as old element was
 				// present, predecessorElementPtr was not broken
-				bss.insert(bss.lower_bound(predecessorElementPtr),
+				bss.set(predecessorElementPtr->id,
 						BrokenSuccessor { predecessorElementPtr, priority });
 			}
 		}
@@ -321,11 +226,7 @@ void SolutionStorage::__update_broken_successors(Solution& solution,
 	{
 		if (isPresent(predecessorsOfOld, predecessorElementPtr)) continue;
 
-		auto it = bss.find(predecessorElementPtr);
-		if (it != bss.end())
-		{
-			bss.erase(it);
-		}
+		bss.erase(predecessorElementPtr->id);
 	}
 }
 
@@ -347,34 +248,16 @@ void SolutionStorage::setPackageEntry(Solution& solution,
 	__dependency_graph.unfoldElement(elementPtr);
 	__update_change_index(solution.id, elementPtr, packageEntry);
 
-	auto it = solution.__added_entries->lower_bound(elementPtr);
-	if (it == solution.__added_entries->end() || it->first != elementPtr)
+	if (conflictingElementPtr && solution.__entries.find(elementPtr->id) &&
+			solution.__entries.find(conflictingElementPtr->id))
 	{
-		// there is no modifiable element in this solution
-		solution.__added_entries->insert(it,
-				make_pair(elementPtr, std::make_shared< const PackageEntry >(std::move(packageEntry))));
+		fatal2i("conflicting elements in the solution '%u': in '%s', out '%s'",
+				solution.id, elementPtr->toString(), conflictingElementPtr->toString());
 	}
-	else
-	{
-		if (conflictingElementPtr && it->second)
-		{
-			fatal2i("conflicting elements in __added_entries: solution '%u', in '%s', out '%s'",
-					solution.id, elementPtr->toString(), conflictingElementPtr->toString());
-		}
-		it->second = std::make_shared< const PackageEntry >(std::move(packageEntry));
-	}
-
+	solution.__entries.set(elementPtr->id, elementPtr, std::move(packageEntry));
 	if (conflictingElementPtr)
 	{
-		auto forRemovalIt = solution.__added_entries->lower_bound(conflictingElementPtr);
-		if (forRemovalIt != solution.__added_entries->end() && forRemovalIt->first == conflictingElementPtr)
-		{
-			forRemovalIt->second.reset();
-		}
-		else
-		{
-			solution.__added_entries->insert(forRemovalIt, { conflictingElementPtr, {} });
-		}
+		solution.__entries.erase(conflictingElementPtr->id);
 	}
 
 	__update_broken_successors(solution, conflictingElementPtr, elementPtr, priority);
@@ -385,23 +268,16 @@ void SolutionStorage::prepareForResolving(Solution& initialSolution,
 			const map< string, dg::InitialPackageEntry >& initialPackages)
 {
 	auto source = __dependency_graph.fill(oldPackages, initialPackages);
-
-	auto comparator = [](const pair< const dg::Element*, SPPE >& left,
-			const pair< const dg::Element*, SPPE >& right)
-	{
-		return left.first < right.first;
-	};
-	std::sort(source.begin(), source.end(), comparator);
-
-	initialSolution.__added_entries->reserve(source.size());
+	// elements get their identifiers when they are created, unfolding in the
+	// order of package names keeps the identifiers independent of the addresses
 	FORIT(it, source)
 	{
 		__dependency_graph.unfoldElement(it->first);
-		initialSolution.__added_entries->push_back(*it);
+		initialSolution.__entries.set(it->first->id, it->first, *it->second);
 	}
-	for (const auto& entry: *initialSolution.__added_entries)
+	FORIT(it, source)
 	{
-		__update_broken_successors(initialSolution, NULL, entry.first, 0);
+		__update_broken_successors(initialSolution, NULL, it->first, 0);
 	}
 
 	__change_index.emplace_back(0);
@@ -449,6 +325,29 @@ void SolutionStorage::unfoldElement(const dg::Element* elementPtr)
 	__dependency_graph.unfoldElement(elementPtr);
 }
 
+void SolutionStorage::setGraphFrozen(bool frozen)
+{
+	__dependency_graph.setFrozen(frozen);
+}
+
+bool SolutionStorage::applyWithFrozenGraph(Solution& solution,
+		const std::function< void (Solution&) >& apply)
+{
+	auto entries = solution.__entries;
+	auto brokenSuccessors = solution.__broken_successors;
+	try
+	{
+		apply(solution);
+		return true;
+	}
+	catch (dg::FrozenGraphChange&)
+	{
+		solution.__entries.swap(entries);
+		solution.__broken_successors.swap(brokenSuccessors);
+		return false;
+	}
+}
+
 vector< const dg::Element* > SolutionStorage::getInsertedElements(const Solution& solution) const
 {
 	vector< const dg::Element* > result;
@@ -466,124 +365,23 @@ vector< const dg::Element* > SolutionStorage::getInsertedElements(const Solution
 
 Solution::Solution()
 	: id(0), level(0), finished(false), score(0)
-{
-	__added_entries.reset(new PackageEntryMap);
-	__broken_successors = new BrokenSuccessorMap;
-}
-
-Solution::~Solution()
-{
-	delete __broken_successors;
-}
-
-template < typename CallbackType >
-void __foreach_solution_element(const PackageEntryMap& masterEntries, const PackageEntryMap& addedEntries,
-		CallbackType callback)
-{
-	class RepackInsertIterator: public std::iterator< std::output_iterator_tag, PackageEntryMap::value_type >
-	{
-		const CallbackType& __callback;
-	 public:
-		RepackInsertIterator(const CallbackType& callback_)
-			: __callback(callback_) {}
-		RepackInsertIterator& operator++() { return *this; }
-		RepackInsertIterator& operator*() { return *this; }
-		void operator=(const PackageEntryMap::value_type& data)
-		{
-			if (data.second)
-			{
-				__callback(data);
-			}
-		}
-	};
-	struct Comparator
-	{
-		bool operator()(const PackageEntryMap::value_type& left, const PackageEntryMap::value_type& right)
-		{ return left.first < right.first; }
-	};
-	// it's important that parent's __added_entries come first,
-	// if two elements are present in both (i.e. an element is overriden)
-	// the new version of an element will be considered
-	std::set_union(addedEntries.begin(), addedEntries.end(),
-			masterEntries.begin(), masterEntries.end(),
-			RepackInsertIterator(callback), Comparator());
-}
-
-void Solution::prepare()
-{
-	if (!__parent)
-	{
-		return; // prepared already
-	}
-
-	if (!__parent->__master_entries)
-	{
-		// parent solution is a master solution, build a slave on top of it
-		__master_entries = __parent->__added_entries;
-	}
-	else
-	{
-		// this a slave solution
-		size_t& forkedCount = __parent->__master_entries->forkedCount;
-		forkedCount += __parent->__added_entries->size();
-		if (forkedCount > __parent->__master_entries->size())
-		{
-			forkedCount = 0;
-
-			// master solution is overdiverted, build new master one
-			__added_entries->reserve(__parent->__added_entries->size() +
-					__parent->__master_entries->size());
-
-			__foreach_solution_element(*__parent->__master_entries, *__parent->__added_entries,
-					[this](const PackageEntryMap::value_type& data) { this->__added_entries->push_back(data); });
-		}
-		else
-		{
-			// build new slave solution from current
-			__master_entries = __parent->__master_entries;
-			*__added_entries = *(__parent->__added_entries);
-		}
-	}
-
-	*__broken_successors = *__parent->__broken_successors;
-	__parent.reset();
-}
+{}
 
 vector< const dg::Element* > Solution::getElements() const
 {
 	vector< const dg::Element* > result;
-
-	static const PackageEntryMap nullPackageEntryMap;
-	const auto& masterEntries = __master_entries ? *__master_entries : nullPackageEntryMap;
-
-	__foreach_solution_element(masterEntries, *__added_entries,
-			[&result](const PackageEntryMap::value_type& data) { result.push_back(data.first); });
-
+	result.reserve(__entries.size());
+	__entries.forEach([&result](uint32_t, const pair< const dg::Element*, PackageEntry >& entry)
+	{
+		result.push_back(entry.first);
+	});
 	return result;
 }
 
-const vector< BrokenSuccessor >& Solution::getBrokenSuccessors() const
-{
-	return __broken_successors->getContainer();
-}
-
 const PackageEntry* Solution::getPackageEntry(const dg::Element* elementPtr) const
 {
-	auto it = __added_entries->find(elementPtr);
-	if (it != __added_entries->end())
-	{
-		return it->second.get();
-	}
-	if (__master_entries)
-	{
-		it = __master_entries->find(elementPtr);
-		if (it != __master_entries->end())
-		{
-			return it->second.get();
-		}
-	}
-
-	return NULL; // not found
+	auto entryPtr = __entries.find(elementPtr->id);
+	return entryPtr ? &entryPtr->second : NULL;
 }
 
 }
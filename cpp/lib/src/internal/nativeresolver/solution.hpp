@@ -21,6 +21,7 @@
 #include <bitset>
 #include <map>
 #include <forward_list>
+#include <functional>
 #include <cstring>
 
 #include <cupt/cache/binaryversion.hpp>
@@ -28,6 +29,8 @@
 
 #include <internal/nativeresolver/score.hpp>
 #include <internal/nativeresolver/dependencygraph.hpp>
+#include <internal/nativeresolver/persistentmap.hpp>
+#include <internal/arena.hpp>
 
 namespace cupt {
 namespace internal {
@@ -75,9 +78,6 @@ struct PackageEntry
 	bool isModificationAllowed(const dg::Element*) const;
 };
 
-class PackageEntryMap;
-class BrokenSuccessorMap;
-
 struct BrokenSuccessor
 {
 	const dg::Element* elementPtr;
@@ -88,10 +88,10 @@ class Solution
 {
 	friend class SolutionStorage;
 
-	shared_ptr< const Solution > __parent;
-	shared_ptr< const PackageEntryMap > __master_entries;
-	shared_ptr< PackageEntryMap > __added_entries;
-	BrokenSuccessorMap*  __broken_successors;
+	// both are keyed by element identifiers and shared with the solutions
+	// this one was cloned from or to
+	PersistentMap< pair< const dg::Element*, PackageEntry > > __entries;
+	PersistentMap< BrokenSuccessor > __broken_successors;
  public:
 	struct Action
 	{
@@ -113,12 +113,17 @@ class Solution
 	Solution();
 	Solution(const Solution&) = delete;
 	Solution& operator=(const Solution&) = delete;
-	~Solution();
 
-	void prepare();
 	vector< const dg::Element* > getElements() const;
 
-	const vector< BrokenSuccessor >& getBrokenSuccessors() const;
+	template < typename Callback >
+	void forEachBrokenSuccessor(const Callback& callback) const
+	{
+		__broken_successors.forEach([&callback](uint32_t, const BrokenSuccessor& brokenSuccessor)
+		{
+			callback(brokenSuccessor);
+		});
+	}
 	// result becomes invalid after any setPackageEntry
 	const PackageEntry* getPackageEntry(const dg::Element*) const;
 };
@@ -128,6 +133,8 @@ class SolutionStorage
 	size_t __next_free_id;
 	size_t __get_new_solution_id(const Solution& parent);
 
+	arena::ArenaPtr __arena; // for solutions
+
 	dg::DependencyGraph __dependency_graph;
 
 	void __update_broken_successors(Solution&,
@@ -166,6 +173,14 @@ class SolutionStorage
 			PackageEntry&&, const dg::Element*, size_t);
 	void unfoldElement(const dg::Element*);
 
+	// see DependencyGraph::setFrozen
+	void setGraphFrozen(bool);
+	// calls 'apply' on the solution; if 'apply' tried to change the frozen
+	// graph, the changes of the solution are reverted and false is returned
+	//
+	// different solutions may be processed this way concurrently
+	bool applyWithFrozenGraph(Solution&, const std::function< void (Solution&) >& apply);
+
 	vector< const dg::Element* > getInsertedElements(const Solution& solution) const;
 };
 
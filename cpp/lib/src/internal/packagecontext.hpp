@@ -0,0 +1,45 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#ifndef CUPT_INTERNAL_PACKAGECONTEXT_SEEN
+#define CUPT_INTERNAL_PACKAGECONTEXT_SEEN
+
+#include <cupt/common.hpp>
+
+#include <internal/arena.hpp>
+#include <internal/versionlru.hpp>
+
+namespace cupt {
+namespace internal {
+
+// what the packages of a cache use to parse their versions; shared with the
+// packages, as they may outlive the cache
+struct PackageContext
+{
+	arena::Arena* arena; // NULL once the cache is destroyed
+	shared_ptr< lru::VersionLru > versionLru; // NULL if disabled
+
+	PackageContext()
+		: arena(NULL)
+	{}
+};
+
+}
+}
+
+#endif
+
@@ -0,0 +1,214 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cupt/config.hpp>
+
+#include <internal/persistentfile.hpp>
+#include <internal/filesystem.hpp>
+
+namespace cupt {
+namespace internal {
+namespace pf {
+
+namespace {
+
+const uint32_t byteOrderMark = 0x01020304;
+
+// the size is a multiple of 8, so records following it are aligned
+struct Header
+{
+	char magic[8];
+	uint32_t formatVersion;
+	uint32_t byteOrderMark;
+	Signature sourceSignature;
+};
+
+}
+
+bool Signature::operator==(const Signature& other) const
+{
+	return size == other.size && modificationTime == other.modificationTime &&
+			modificationTimeNsec == other.modificationTimeNsec && inode == other.inode;
+}
+
+bool getSignature(const string& path, Signature& signature)
+{
+	struct stat st;
+	if (stat(path.c_str(), &st) == -1)
+	{
+		return false;
+	}
+	signature.size = st.st_size;
+	signature.modificationTime = st.st_mtim.tv_sec;
+	signature.modificationTimeNsec = st.st_mtim.tv_nsec;
+	signature.inode = st.st_ino;
+	return true;
+}
+
+Reader::Reader(const string& path, const Format& format, const Signature& sourceSignature)
+	: __mapped_file(path, MappedFile::Access::Map), __body(NULL), __body_size(0)
+{
+	auto data = __mapped_file.data();
+	if (!data || __mapped_file.size() < sizeof(Header))
+	{
+		return;
+	}
+
+	Header header;
+	memcpy(&header, data, sizeof(header));
+	if (memcmp(header.magic, format.magic, sizeof(format.magic)) ||
+			header.formatVersion != format.version ||
+			header.byteOrderMark != byteOrderMark ||
+			!(header.sourceSignature == sourceSignature))
+	{
+		return; // out of date or foreign
+	}
+
+	__body = data + sizeof(Header);
+	__body_size = __mapped_file.size() - sizeof(Header);
+}
+
+bool Reader::isValid() const
+{
+	return __body;
+}
+
+const char* Reader::getBody() const
+{
+	return __body;
+}
+
+size_t Reader::getBodySize() const
+{
+	return __body_size;
+}
+
+Writer::Writer(int fd)
+	: __fd(fd), __failed(false)
+{}
+
+void Writer::put(const char* data, size_t size)
+{
+	while (size && !__failed)
+	{
+		auto writtenSize = ::write(__fd, data, size);
+		if (writtenSize == -1)
+		{
+			__failed = (errno != EINTR);
+			continue;
+		}
+		data += writtenSize;
+		size -= writtenSize;
+	}
+}
+
+void Writer::put(const string& bytes)
+{
+	put(bytes.data(), bytes.size());
+}
+
+bool Writer::isFailed() const
+{
+	return __failed;
+}
+
+WriteLock::WriteLock(const Config& config, const string& lockPath)
+	: __fd(-1), __acquired(false)
+{
+	if (!config.getBool("cupt::worker::use-locks"))
+	{
+		__acquired = true;
+		return;
+	}
+	__fd = open(lockPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0640);
+	if (__fd == -1)
+	{
+		return; // most likely, not enough rights, so nothing could be written anyway
+	}
+	__acquired = (flock(__fd, LOCK_EX | LOCK_NB) == 0);
+}
+
+WriteLock::~WriteLock()
+{
+	if (__fd != -1)
+	{
+		close(__fd); // releases the lock as well
+	}
+}
+
+bool WriteLock::isAcquired() const
+{
+	return __acquired;
+}
+
+bool write(const string& path, const Format& format, const Signature& sourceSignature,
+		const std::function< void (Writer&) >& putBody)
+{
+	Header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, format.magic, sizeof(format.magic));
+	header.formatVersion = format.version;
+	header.byteOrderMark = byteOrderMark;
+	header.sourceSignature = sourceSignature;
+
+	string temporaryPath = path + ".XXXXXX";
+	int fd = mkstemp(&temporaryPath[0]);
+	if (fd == -1)
+	{
+		return false; // most likely, not enough rights
+	}
+
+	Writer writer(fd);
+	bool success = false;
+	try
+	{
+		writer.put(reinterpret_cast< const char* >(&header), sizeof(header));
+		putBody(writer);
+		// mkstemp creates files readable only by the owner
+		success = !writer.isFailed() && fchmod(fd, 0644) == 0 && fsync(fd) == 0;
+	}
+	catch (...)
+	{
+		close(fd);
+		unlink(temporaryPath.c_str());
+		throw;
+	}
+	success = (close(fd) == 0) && success;
+	if (success && !fs::move(temporaryPath, path))
+	{
+		success = false;
+	}
+	if (!success)
+	{
+		unlink(temporaryPath.c_str());
+	}
+	return success;
+}
+}
+}
+}
+
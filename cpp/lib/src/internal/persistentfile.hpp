@@ -0,0 +1,118 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#ifndef CUPT_INTERNAL_PERSISTENTFILE_SEEN
+#define CUPT_INTERNAL_PERSISTENTFILE_SEEN
+
+#include <functional>
+
+#include <cupt/common.hpp>
+#include <cupt/fwd.hpp>
+
+#include <internal/mappedfile.hpp>
+
+namespace cupt {
+namespace internal {
+
+// "persistent file": a binary file derived from some source file (an index,
+// the dpkg status file etc.) which is valid only as long as the source file
+// is not changed; the common machinery of such files
+namespace pf {
+
+// identifies the contents of a file without reading it
+struct Signature
+{
+	uint64_t size;
+	int64_t modificationTime;
+	int64_t modificationTimeNsec;
+	uint64_t inode;
+
+	bool operator==(const Signature&) const;
+};
+bool getSignature(const string& path, Signature&);
+
+struct Format
+{
+	char magic[8];
+	uint32_t version;
+};
+
+// a persistent file is mapped and its header is verified; all integers are
+// stored in the native byte order, so a file written on another architecture
+// is rejected as well; persistent files are only ever replaced by renaming,
+// so the mapping is safe
+class Reader
+{
+	MappedFile __mapped_file;
+	const char* __body;
+	size_t __body_size;
+
+	Reader(const Reader&);
+	Reader& operator=(const Reader&);
+ public:
+	Reader(const string& path, const Format&, const Signature& sourceSignature);
+	// false if the file doesn't exist, is of another format or was made for
+	// a source file with another signature
+	bool isValid() const;
+	// what follows the header; the body is aligned to 8 bytes
+	const char* getBody() const;
+	size_t getBodySize() const;
+};
+
+// the sink for the body of a persistent file; errors are only remembered,
+// a failed write just leaves the persistent file out of date
+class Writer
+{
+	int __fd;
+	bool __failed;
+ public:
+	explicit Writer(int fd);
+	void put(const char*, size_t);
+	void put(const string&);
+	bool isFailed() const;
+};
+
+// an advisory lock on the lock file guarding the source files; persistent
+// files are written only while it is held, so two processes don't race over
+// one of them and a source file is not replaced in the middle of writing;
+// it is only tried, if it is busy the persistent files are just not written
+class WriteLock
+{
+	int __fd;
+	bool __acquired;
+
+	WriteLock(const WriteLock&);
+	WriteLock& operator=(const WriteLock&);
+ public:
+	WriteLock(const Config&, const string& lockPath);
+	~WriteLock();
+	bool isAcquired() const;
+};
+
+// writes the header and then the body using 'putBody' to a unique temporary
+// file in the same directory, and renames it to 'path' once it is synced;
+// the caller has to hold the write lock; on errors the temporary file is
+// removed and false is returned, the file will be made next time again
+bool write(const string& path, const Format&, const Signature& sourceSignature,
+		const std::function< void (Writer&) >& putBody);
+}
+
+}
+}
+
+#endif
+
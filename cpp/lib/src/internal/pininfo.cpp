@@ -31,6 +31,7 @@
 #include <internal/filesystem.hpp>
 #include <internal/common.hpp>
 #include <internal/regex.hpp>
+#include <internal/versionkey.hpp>
 
 namespace cupt {
 namespace internal {
@@ -39,93 +40,204 @@ using cache::Version;
 using cache::BinaryVersion;
 using cache::ReleaseInfo;
 
+string getHostNameInAptPreferencesStyle(const string& baseUri)
+{
+	if (baseUri.empty())
+	{
+		return "<installed>";
+	}
+	else
+	{
+		const download::Uri uri(baseUri);
+		if (uri.getProtocol() == "file" || uri.getProtocol() == "copy")
+		{
+			return ""; // "local site"
+		}
+		else
+		{
+			return uri.getHost();
+		}
+	}
+}
+
 PinInfo::PinInfo(const shared_ptr< const Config >& config,
-		const shared_ptr< const system::State >& systemState)
-	: config(config), systemState(systemState)
+		const shared_ptr< const system::State >& systemState,
+		const vector< shared_ptr< const ReleaseInfo > >& releases)
+	: config(config), systemState(systemState), conditionCount(0)
 {
+	defaultRelease = config->getString("apt::default-release");
+	// these are Cupt-specific
+	notAutomaticAddendum = config->getInteger("cupt::cache::pin::addendums::not-automatic");
+	butAutomaticUpgradesAddendum = config->getInteger("cupt::cache::pin::addendums::but-automatic-upgrades");
+	downgradeAddendum = config->getInteger("cupt::cache::pin::addendums::downgrade");
+	holdAddendum = config->getInteger("cupt::cache::pin::addendums::hold");
+
 	init();
+
+	FORIT(releaseIt, releases)
+	{
+		auto id = (*releaseIt)->id;
+		if (id >= releaseTraits.size())
+		{
+			releaseTraits.resize(id + 1, ReleaseTraits { NULL, 0, {} });
+		}
+		releaseTraits[id] = computeReleaseTraits(**releaseIt);
+	}
 }
 
-ssize_t PinInfo::getOriginalAptPin(const shared_ptr< const Version >& version) const
+PinInfo::ReleaseTraits PinInfo::computeReleaseTraits(const ReleaseInfo& release) const
 {
 	static const ssize_t defaultReleasePriority = 990;
 	static const ssize_t notAutomaticReleasePriority = 1;
 	static const ssize_t installedPriority = 100;
 	static const ssize_t defaultPriority = 500;
 
-	auto defaultRelease = config->getString("apt::default-release");
+	ReleaseTraits result;
+	result.release = &release;
 
-	// these are Cupt-specific
-	ssize_t notAutomaticAddendum = config->getInteger("cupt::cache::pin::addendums::not-automatic");
-	ssize_t butAutomaticUpgradesAddendum = config->getInteger("cupt::cache::pin::addendums::but-automatic-upgrades");
-
-	ssize_t result = std::min((ssize_t)0, notAutomaticAddendum);
+	result.priority = defaultPriority;
+	if (!defaultRelease.empty() &&
+		(release.archive == defaultRelease || release.codename == defaultRelease))
+	{
+		result.priority = defaultReleasePriority;
+	}
+	else if (release.notAutomatic)
+	{
+		result.priority = notAutomaticReleasePriority + notAutomaticAddendum;
+		if (release.butAutomaticUpgrades)
+		{
+			result.priority += butAutomaticUpgradesAddendum;
+		}
+	}
+	else if (release.archive == "installed")
+	{
+		result.priority = installedPriority;
+	}
 
-	size_t sourceCount = version->sources.size();
-	for (size_t i = 0; i < sourceCount; ++i)
+	result.matchedConditions.resize(conditionCount);
+	smatch m;
+	FORIT(pinEntryIt, settings)
 	{
-		const Version::Source& entry = version->sources[i];
-		auto currentPriority = defaultPriority;
-		if (!defaultRelease.empty() &&
-			(entry.release->archive == defaultRelease || entry.release->codename == defaultRelease))
+		FORIT(conditionIt, pinEntryIt->conditions)
 		{
-			currentPriority = defaultReleasePriority;
+			const sregex& regex = *conditionIt->value;
+			bool matched;
+			switch (conditionIt->type)
+			{
+				case PinEntry::Condition::HostName:
+					matched = regex_search(getHostNameInAptPreferencesStyle(release.baseUri), m, regex);
+					break;
+				case PinEntry::Condition::ReleaseArchive:
+					matched = regex_search(release.archive, m, regex);
+					break;
+				case PinEntry::Condition::ReleaseVendor:
+					matched = regex_search(release.vendor, m, regex);
+					break;
+				case PinEntry::Condition::ReleaseVersion:
+					matched = regex_search(release.version, m, regex);
+					break;
+				case PinEntry::Condition::ReleaseComponent:
+					matched = regex_search(release.component, m, regex);
+					break;
+				case PinEntry::Condition::ReleaseCodename:
+					matched = regex_search(release.codename, m, regex);
+					break;
+				case PinEntry::Condition::ReleaseLabel:
+					matched = regex_search(release.label, m, regex);
+					break;
+				default:
+					continue; // not a release condition
+			}
+			result.matchedConditions[conditionIt->index] = matched;
 		}
-		else if (entry.release->notAutomatic)
+	}
+
+	return result;
+}
+
+// package names are few compared to versions, so matches are remembered per name
+const vector< bool >& PinInfo::getNameMatches(unordered_map< string, vector< bool > >& storage,
+		const string& name, PinEntry::Condition::Type type) const
+{
+	std::lock_guard< std::mutex > lock(nameMatchesMutex);
+
+	auto insertResult = storage.insert({ name, vector< bool >() });
+	vector< bool >& result = insertResult.first->second;
+	if (insertResult.second)
+	{
+		result.resize(conditionCount);
+		smatch m;
+		FORIT(pinEntryIt, settings)
 		{
-			currentPriority = notAutomaticReleasePriority + notAutomaticAddendum;
-			if (entry.release->butAutomaticUpgrades)
+			FORIT(conditionIt, pinEntryIt->conditions)
 			{
-				currentPriority += butAutomaticUpgradesAddendum;
+				if (conditionIt->type == type)
+				{
+					result[conditionIt->index] = regex_search(name, m, *conditionIt->value);
+				}
 			}
 		}
-		else if (entry.release->archive == "installed")
+	}
+	return result;
+}
+
+ssize_t PinInfo::getOriginalAptPin(const Version& version) const
+{
+	ssize_t result = std::min((ssize_t)0, notAutomaticAddendum);
+
+	vector< const ReleaseTraits* > sourceReleaseTraits;
+	vector< ReleaseTraits > unknownReleaseTraits;
+	unknownReleaseTraits.reserve(version.sources.size());
+	FORIT(sourceIt, version.sources)
+	{
+		const ReleaseInfo* release = sourceIt->release.get();
+		if (release->id < releaseTraits.size() && releaseTraits[release->id].release == release)
+		{
+			sourceReleaseTraits.push_back(&releaseTraits[release->id]);
+		}
+		else
 		{
-			currentPriority = installedPriority;
+			unknownReleaseTraits.push_back(computeReleaseTraits(*sourceIt->release));
+			sourceReleaseTraits.push_back(&unknownReleaseTraits.back());
 		}
 
-		if (result < currentPriority)
+		if (result < sourceReleaseTraits.back()->priority)
 		{
-			result = currentPriority;
+			result = sourceReleaseTraits.back()->priority;
 		}
 	}
 
-	adjustUsingPinSettings(version, result);
+	adjustUsingPinSettings(version, sourceReleaseTraits, result);
 
 	return result;
 }
 
-ssize_t PinInfo::getPin(const shared_ptr< const Version >& version,
-		const string& installedVersionString) const
+ssize_t PinInfo::getPin(const Version& version, const string& installedVersionString,
+		const string* installedVersionKey, const system::State::InstalledRecord* installedInfo) const
 {
 	auto result = getOriginalAptPin(version);
 
 	// adjust for downgrades and holds
 	if (!installedVersionString.empty())
 	{
-		auto installedInfo = systemState->getInstalledInfo(version->packageName);
-		if (!installedInfo)
-		{
-			fatal2i("missing installed info for package '%s'", version->packageName);
-		}
-
-		if (compareVersionStrings(installedVersionString, version->versionString) > 0)
+		if (versionkey::compare(installedVersionKey, installedVersionString,
+				versionkey::get(version), version.versionString) > 0)
 		{
-			result += config->getInteger("cupt::cache::pin::addendums::downgrade");
+			result += downgradeAddendum;
 		}
 
-		auto binaryVersion = dynamic_pointer_cast< const BinaryVersion >(version);
+		auto binaryVersion = dynamic_cast< const BinaryVersion* >(&version);
 		if (!binaryVersion)
 		{
 			fatal2i("version is not binary");
 		}
 		if (installedInfo->want == system::State::InstalledRecord::Want::Hold && binaryVersion->isInstalled())
 		{
-			result += config->getInteger("cupt::cache::pin::addendums::hold");
+			result += holdAddendum;
 		}
 	}
 
-	if (version->isVerified())
+	if (version.isVerified())
 	{
 		result += 1;
 	}
@@ -133,6 +245,45 @@ ssize_t PinInfo::getPin(const shared_ptr< const Version >& version,
 	return result;
 }
 
+ssize_t PinInfo::getPin(const shared_ptr< const Version >& version,
+		const string& installedVersionString) const
+{
+	return getPins({ version }, installedVersionString)[0];
+}
+
+vector< ssize_t > PinInfo::getPins(const vector< shared_ptr< const Version > >& versions,
+		const string& installedVersionString) const
+{
+	vector< ssize_t > result;
+	if (versions.empty())
+	{
+		return result;
+	}
+	result.reserve(versions.size());
+
+	const system::State::InstalledRecord* installedInfo = NULL;
+	shared_ptr< const system::State::InstalledRecord > installedInfoHolder;
+	const string* installedVersionKey = NULL;
+	if (!installedVersionString.empty())
+	{
+		installedVersionKey = versionkey::get(installedVersionString);
+
+		const string& packageName = versions[0]->packageName;
+		installedInfoHolder = systemState->getInstalledInfo(packageName);
+		if (!installedInfoHolder)
+		{
+			fatal2i("missing installed info for package '%s'", packageName);
+		}
+		installedInfo = installedInfoHolder.get();
+	}
+
+	FORIT(versionIt, versions)
+	{
+		result.push_back(getPin(**versionIt, installedVersionString, installedVersionKey, installedInfo));
+	}
+	return result;
+}
+
 string pinStringToRegexString(const string& input)
 {
 	if (input.size() >= 2 && input[0] == '/' && *input.rbegin() == '/')
@@ -214,6 +365,7 @@ void PinInfo::loadData(const string& path)
 					*it = pinStringToRegexString(*it);
 				}
 				condition.value = stringToRegex(join("|", parts));
+				condition.index = conditionCount++;
 				pinEntry.conditions.push_back(std::move(condition));
 			}
 
@@ -261,6 +413,7 @@ void PinInfo::loadData(const string& path)
 										subExpressionType);
 						}
 						condition.value = stringToRegex(pinStringToRegexString(m[2]));
+						condition.index = conditionCount++;
 						pinEntry.conditions.push_back(std::move(condition));
 					}
 				}
@@ -269,6 +422,7 @@ void PinInfo::loadData(const string& path)
 					PinEntry::Condition condition;
 					condition.type = PinEntry::Condition::Version;
 					condition.value = stringToRegex(pinStringToRegexString(pinExpression));
+					condition.index = conditionCount++;
 					pinEntry.conditions.push_back(condition);
 				}
 				else if (pinType == "origin")
@@ -280,6 +434,7 @@ void PinInfo::loadData(const string& path)
 						pinExpression = pinExpression.substr(1, pinExpression.size() - 2); // trimming quotes
 					}
 					condition.value = stringToRegex(pinStringToRegexString(pinExpression));
+					condition.index = conditionCount++;
 					pinEntry.conditions.push_back(condition);
 				}
 				else
@@ -321,27 +476,8 @@ void PinInfo::loadData(const string& path)
 	}
 }
 
-string getHostNameInAptPreferencesStyle(const string& baseUri)
-{
-	if (baseUri.empty())
-	{
-		return "<installed>";
-	}
-	else
-	{
-		const download::Uri uri(baseUri);
-		if (uri.getProtocol() == "file" || uri.getProtocol() == "copy")
-		{
-			return ""; // "local site"
-		}
-		else
-		{
-			return uri.getHost();
-		}
-	}
-}
-
-void PinInfo::adjustUsingPinSettings(const shared_ptr< const Version >& version, ssize_t& priority) const
+void PinInfo::adjustUsingPinSettings(const Version& version,
+		const vector< const ReleaseTraits* >& sourceReleaseTraits, ssize_t& priority) const
 {
 	smatch m;
 
@@ -352,49 +488,38 @@ void PinInfo::adjustUsingPinSettings(const shared_ptr< const Version >& version,
 		FORIT(conditionIt, conditions)
 		{
 			const PinEntry::Condition& condition = *conditionIt;
-			const shared_ptr< sregex >& regex = condition.value;
 
 			switch (condition.type)
 			{
 				case PinEntry::Condition::PackageName:
-					matched = regex_search(version->packageName, m, *regex);
+					matched = getNameMatches(packageNameMatches, version.packageName,
+							condition.type)[condition.index];
 					break;
 				case PinEntry::Condition::SourcePackageName:
 					{
-						auto binaryVersion = dynamic_pointer_cast< const BinaryVersion >(version);
+						auto binaryVersion = dynamic_cast< const BinaryVersion* >(&version);
 						if (!binaryVersion)
 						{
 							matched = false;
 							break;
 						}
-						matched = regex_search(binaryVersion->sourcePackageName, m, *regex);
+						matched = getNameMatches(sourcePackageNameMatches, binaryVersion->sourcePackageName,
+								condition.type)[condition.index];
 					}
 					break;
 				case PinEntry::Condition::Version:
-					matched = regex_search(version->versionString, m, *regex);
+					matched = regex_search(version.versionString, m, *condition.value);
 					break;
-#define RELEASE_CASE(constant, expression) \
-				case PinEntry::Condition::constant: \
-					matched = false; \
-					FORIT(sourceIt, version->sources) \
-					{ \
-						const shared_ptr< const ReleaseInfo >& release = sourceIt->release; \
-						if (regex_search(expression, m, *regex)) \
-						{ \
-							matched = true; \
-							break; \
-						} \
-					} \
-					break;
-
-				RELEASE_CASE(HostName, getHostNameInAptPreferencesStyle(release->baseUri))
-				RELEASE_CASE(ReleaseArchive, release->archive)
-				RELEASE_CASE(ReleaseVendor, release->vendor)
-				RELEASE_CASE(ReleaseVersion, release->version)
-				RELEASE_CASE(ReleaseComponent, release->component)
-				RELEASE_CASE(ReleaseCodename, release->codename)
-				RELEASE_CASE(ReleaseLabel, release->label)
-#undef RELEASE_CASE
+				default: // release conditions
+					matched = false;
+					FORIT(traitsIt, sourceReleaseTraits)
+					{
+						if ((*traitsIt)->matchedConditions[condition.index])
+						{
+							matched = true;
+							break;
+						}
+					}
 			}
 			if (!matched)
 			{
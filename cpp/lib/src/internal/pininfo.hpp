@@ -18,15 +18,21 @@
 #ifndef CUPT_INTERNAL_PININFO_SEEN
 #define CUPT_INTERNAL_PININFO_SEEN
 
+#include <unordered_map>
+#include <mutex>
+
 #include <boost/xpressive/xpressive_fwd.hpp>
 
 #include <cupt/common.hpp>
 #include <cupt/fwd.hpp>
+#include <cupt/system/state.hpp>
 
 namespace cupt {
 namespace internal {
 
 using cache::Version;
+using cache::ReleaseInfo;
+using std::unordered_map;
 
 using boost::xpressive::sregex;
 
@@ -41,24 +47,58 @@ class PinInfo
 
 			Type type;
 			shared_ptr< sregex > value;
+			size_t index; // among all conditions of all entries
 		};
 
 		vector< Condition > conditions;
 		ssize_t priority;
 	};
+	// what preferences say about versions from a certain release
+	struct ReleaseTraits
+	{
+		const ReleaseInfo* release; // NULL for unused identifiers
+		ssize_t priority;
+		vector< bool > matchedConditions; // meaningful only for release conditions
+	};
 
 	shared_ptr< const Config > config;
 	shared_ptr< const system::State > systemState;
 	vector< PinEntry > settings;
+	size_t conditionCount;
+
+	// configuration values, read once
+	string defaultRelease;
+	ssize_t notAutomaticAddendum;
+	ssize_t butAutomaticUpgradesAddendum;
+	ssize_t downgradeAddendum;
+	ssize_t holdAddendum;
+
+	// the decision table
+	vector< ReleaseTraits > releaseTraits; // indexed by release identifiers
+	mutable unordered_map< string, vector< bool > > packageNameMatches;
+	mutable unordered_map< string, vector< bool > > sourcePackageNameMatches;
+	mutable std::mutex nameMatchesMutex;
 
 	void init();
 	void loadData(const string& path);
-	ssize_t getOriginalAptPin(const shared_ptr< const Version >&) const;
-	void adjustUsingPinSettings(const shared_ptr< const Version >&, ssize_t& priority) const;
+	ReleaseTraits computeReleaseTraits(const ReleaseInfo&) const;
+	const vector< bool >& getNameMatches(unordered_map< string, vector< bool > >&,
+			const string&, PinEntry::Condition::Type) const;
+	ssize_t getOriginalAptPin(const Version&) const;
+	void adjustUsingPinSettings(const Version&, const vector< const ReleaseTraits* >&, ssize_t& priority) const;
+	ssize_t getPin(const Version&, const string& installedVersionString,
+			const string* installedVersionKey, const system::State::InstalledRecord* installedInfo) const;
  public:
-	PinInfo(const shared_ptr< const Config >&, const shared_ptr< const system::State >&);
+	// 'releases' are all releases versions may come from, they are
+	// precomputed; pins for versions from other releases are still right,
+	// only slower
+	PinInfo(const shared_ptr< const Config >&, const shared_ptr< const system::State >&,
+			const vector< shared_ptr< const ReleaseInfo > >& releases);
 
 	ssize_t getPin(const shared_ptr< const Version >&, const string& installedVersionString) const;
+	// pins of versions of the same package, in one pass
+	vector< ssize_t > getPins(const vector< shared_ptr< const Version > >&,
+			const string& installedVersionString) const;
 };
 
 }
@@ -0,0 +1,92 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#include <functional>
+
+#include <internal/relationexpressionmemo.hpp>
+
+namespace cupt {
+namespace internal {
+
+size_t RelationExpressionMemo::__hash(const RelationExpression& relationExpression)
+{
+	std::hash< string > hashString;
+	size_t result = relationExpression.size();
+	FORIT(relationIt, relationExpression)
+	{
+		result = result * 31 + hashString(relationIt->packageName);
+		result = result * 31 + relationIt->relationType;
+		if (relationIt->relationType != cache::Relation::Types::None)
+		{
+			result = result * 31 + hashString(relationIt->versionString);
+		}
+	}
+	return result;
+}
+
+void RelationExpressionMemo::__remember(const RelationExpression& relationExpression, uint32_t index) const
+{
+	relationExpression.__memo_owner = this;
+	relationExpression.__memo_index = index;
+}
+
+auto RelationExpressionMemo::find(const RelationExpression& relationExpression) const -> const Value*
+{
+	if (relationExpression.__memo_owner == this && relationExpression.__memo_index < __entries.size())
+	{
+		const Entry& entry = __entries[relationExpression.__memo_index];
+		if (entry.relationExpression == relationExpression)
+		{
+			return &entry.value;
+		}
+	}
+
+	auto range = __index.equal_range(__hash(relationExpression));
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		const Entry& entry = __entries[it->second];
+		if (entry.relationExpression == relationExpression)
+		{
+			__remember(relationExpression, it->second);
+			return &entry.value;
+		}
+	}
+	return NULL;
+}
+
+void RelationExpressionMemo::add(const RelationExpression& relationExpression, const Value& value)
+{
+	uint32_t index = __entries.size();
+	__entries.push_back(Entry { relationExpression, value });
+	__index.insert({ __hash(relationExpression), index });
+	__remember(relationExpression, index);
+}
+
+size_t RelationExpressionMemo::size() const
+{
+	return __entries.size();
+}
+
+void RelationExpressionMemo::clear()
+{
+	__entries.clear();
+	__index.clear();
+}
+
+}
+}
+
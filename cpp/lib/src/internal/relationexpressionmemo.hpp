@@ -0,0 +1,67 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#ifndef CUPT_INTERNAL_RELATIONEXPRESSIONMEMO_SEEN
+#define CUPT_INTERNAL_RELATIONEXPRESSIONMEMO_SEEN
+
+#include <unordered_map>
+
+#include <cupt/common.hpp>
+#include <cupt/fwd.hpp>
+#include <cupt/cache/relation.hpp>
+
+namespace cupt {
+namespace internal {
+
+using cache::RelationExpression;
+using cache::BinaryVersion;
+
+// satisfying versions of the relation expressions seen by a cache
+//
+// an expression remembers the memo which looked it up last and the index of
+// its entry there, so repeated lookups of the same expression object cost one
+// comparison; as this is only a hint, the entry is still compared with the
+// contents, and expressions seen first time (copies, new objects) are found by
+// the hash of the contents
+class RelationExpressionMemo
+{
+ public:
+	typedef vector< shared_ptr< const BinaryVersion > > Value;
+ private:
+	struct Entry
+	{
+		RelationExpression relationExpression; // a copy to compare with
+		Value value;
+	};
+	vector< Entry > __entries;
+	std::unordered_multimap< size_t, uint32_t > __index; // contents hash -> entry index
+
+	static size_t __hash(const RelationExpression&);
+	void __remember(const RelationExpression&, uint32_t) const;
+ public:
+	// NULL if not memoized
+	const Value* find(const RelationExpression&) const;
+	void add(const RelationExpression&, const Value&);
+	size_t size() const;
+	void clear();
+};
+
+}
+}
+
+#endif
+
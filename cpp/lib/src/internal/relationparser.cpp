@@ -0,0 +1,428 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#include <algorithm>
+
+#include <cupt/cache/version.hpp>
+
+#include <internal/relationparser.hpp>
+#include <internal/versionkey.hpp>
+
+namespace cupt {
+namespace internal {
+namespace relationparser {
+
+typedef cache::Relation::Types Types;
+
+namespace {
+
+inline bool isPackageNameCharacter(char c)
+{
+	// "[a-z_0-9.+-]", see consumePackageName()
+	return (c >= 'a' && c <= 'z') || c == '_' || (c >= '0' && c <= '9') ||
+			c == '.' || c == '+' || c == '-';
+}
+
+inline const char* skipSpaces(const char* current, const char* end)
+{
+	while (current != end && *current == ' ')
+	{
+		++current;
+	}
+	return current;
+}
+
+// the part after '(', [versionBegin, versionEnd) gets the version string
+bool parseVersionedInfo(const char* current, const char* end, Types::Type& relationType,
+		const char*& versionBegin, const char*& versionEnd)
+{
+	if (current == end || current+1 == end /* version should at least have one character */)
+	{
+		return false;
+	}
+	switch (*current)
+	{
+		case '>':
+			if (*(current+1) == '=')
+			{
+				relationType = Types::MoreOrEqual;
+				current += 2;
+			}
+			else
+			{
+				relationType = Types::More;
+				current += (*(current+1) == '>') ? 2 : 1;
+			}
+			break;
+		case '=':
+			relationType = Types::Equal;
+			current += 1;
+			break;
+		case '<':
+			if (*(current+1) == '=')
+			{
+				relationType = Types::LessOrEqual;
+				current += 2;
+			}
+			else
+			{
+				relationType = Types::Less;
+				current += (*(current+1) == '<') ? 2 : 1;
+			}
+			break;
+		default:
+			return false;
+	}
+	current = skipSpaces(current, end);
+	if (current == end)
+	{
+		return false;
+	}
+	const char* versionStringEnd = current+1;
+	while (versionStringEnd != end && *versionStringEnd != ')' && *versionStringEnd != ' ')
+	{
+		++versionStringEnd;
+	}
+	if (versionStringEnd == end)
+	{
+		return false; // at least ')' after version string should be
+	}
+	versionBegin = current;
+	versionEnd = versionStringEnd;
+
+	current = skipSpaces(versionStringEnd, end);
+	if (current == end || *current != ')')
+	{
+		return false;
+	}
+	return (skipSpaces(current+1, end) == end);
+}
+
+// finds the next 'symbol' surrounded by optional spaces in [begin, end),
+// see internal::processSpaceCommaSpaceDelimitedStrings()
+inline bool findDelimiter(const char* begin, const char* end, char symbol,
+		const char*& delimiterBegin, const char*& delimiterEnd)
+{
+	for (const char* current = begin; current != end; ++current)
+	{
+		if (*current == symbol)
+		{
+			delimiterBegin = current;
+			while (delimiterBegin != begin && *(delimiterBegin-1) == ' ')
+			{
+				--delimiterBegin;
+			}
+			delimiterEnd = skipSpaces(current+1, end);
+			return true;
+		}
+	}
+	return false;
+}
+
+// every relation but the first one follows a delimiter
+size_t getMaxRecordCount(const char* begin, const char* end)
+{
+	size_t result = 1;
+	for (const char* current = begin; current != end; ++current)
+	{
+		if (*current == ',' || *current == '|')
+		{
+			++result;
+		}
+	}
+	return result;
+}
+
+void appendRecord(const cache::Relation& relation, bool isLastAlternative, vector< Record >& records)
+{
+	Record record;
+	record.packageName = stringpool::intern(relation.packageName);
+	record.relationType = relation.relationType;
+	if (record.relationType != Types::None)
+	{
+		record.versionString = stringpool::intern(relation.versionString);
+		record.versionKey = versionkey::get(*record.versionString);
+	}
+	else
+	{
+		record.versionString = NULL;
+		record.versionKey = NULL;
+	}
+	record.isLastAlternative = isLastAlternative;
+	records.push_back(record);
+}
+
+}
+
+namespace {
+
+// splits the relation [begin, end) into its parts, throws on errors
+void splitRelation(const char* begin, const char* end, const char*& packageNameEnd,
+		Types::Type& relationType, const char*& versionBegin, const char*& versionEnd)
+{
+	relationType = Types::None;
+
+	const char* current = begin;
+	while (current != end && isPackageNameCharacter(*current))
+	{
+		++current;
+	}
+	if (current == begin)
+	{
+		fatal2(__("failed to parse a package name in the relation '%s'"), string(begin, end));
+	}
+	packageNameEnd = current;
+
+	current = skipSpaces(current, end);
+	if (current != end && *current == '(')
+	{
+		if (!parseVersionedInfo(current+1, end, relationType, versionBegin, versionEnd))
+		{
+			fatal2(__("failed to parse a version part in the relation '%s'"), string(begin, end));
+		}
+	}
+}
+
+// calls 'callback' with each relation of the line and whether it ends an
+// expression
+template < typename Callback >
+void forEachRelation(const char* begin, const char* end, const Callback& callback)
+{
+	const char* current = begin;
+	const char* delimiterBegin;
+	const char* delimiterEnd = end;
+	bool expressionEnds;
+	do
+	{
+		const char* expressionEnd = end;
+		expressionEnds = findDelimiter(current, end, ',', delimiterBegin, delimiterEnd);
+		if (expressionEnds)
+		{
+			expressionEnd = delimiterBegin;
+		}
+		const char* nextExpression = delimiterEnd;
+
+		while (findDelimiter(current, expressionEnd, '|', delimiterBegin, delimiterEnd))
+		{
+			callback(current, delimiterBegin, false);
+			current = delimiterEnd;
+		}
+		callback(current, expressionEnd, true);
+		current = nextExpression;
+	}
+	while (expressionEnds);
+}
+
+// interns straight in the shared string pool
+struct SharedPool
+{
+	stringpool::Handle intern(const char* data, size_t size)
+	{
+		return stringpool::intern(data, size);
+	}
+	const string* getVersionKey(stringpool::Handle versionString)
+	{
+		checkVersionString(*versionString);
+		return versionkey::get(*versionString);
+	}
+};
+
+template < typename Pool >
+void parseRelation(const char* begin, const char* end, Record& record, Pool& pool)
+{
+	const char* packageNameEnd;
+	const char* versionBegin;
+	const char* versionEnd;
+	splitRelation(begin, end, packageNameEnd, record.relationType, versionBegin, versionEnd);
+
+	record.packageName = pool.intern(begin, packageNameEnd - begin);
+	if (record.relationType != Types::None)
+	{
+		record.versionString = pool.intern(versionBegin, versionEnd - versionBegin);
+		record.versionKey = pool.getVersionKey(record.versionString);
+	}
+	else
+	{
+		record.versionString = NULL;
+		record.versionKey = NULL;
+	}
+	record.isLastAlternative = false;
+}
+
+template < typename Pool >
+void parseLine(const char* begin, const char* end, vector< Record >& records, Pool& pool)
+{
+	forEachRelation(begin, end, [&records, &pool](const char* relationBegin, const char* relationEnd, bool isLastAlternative)
+	{
+		Record record;
+		parseRelation(relationBegin, relationEnd, record, pool);
+		record.isLastAlternative = isLastAlternative;
+		records.push_back(record);
+	});
+}
+
+}
+
+void parseRelation(const char* begin, const char* end, Record& record)
+{
+	SharedPool pool;
+	parseRelation(begin, end, record, pool);
+}
+
+void parseExpression(const char* begin, const char* end, vector< Record >& records)
+{
+	Record record;
+	const char* current = begin;
+	const char* delimiterBegin;
+	const char* delimiterEnd;
+	while (findDelimiter(current, end, '|', delimiterBegin, delimiterEnd))
+	{
+		parseRelation(current, delimiterBegin, record);
+		records.push_back(record);
+		current = delimiterEnd;
+	}
+	parseRelation(current, end, record);
+	record.isLastAlternative = true;
+	records.push_back(record);
+}
+
+void parseLine(const char* begin, const char* end, vector< Record >& records)
+{
+	SharedPool pool;
+	parseLine(begin, end, records, pool);
+}
+
+stringpool::Handle LocalCache::intern(const char* data, size_t size)
+{
+	return __strings.intern(data, size);
+}
+
+const string* LocalCache::getVersionKey(stringpool::Handle versionString)
+{
+	auto it = __version_keys.find(versionString);
+	if (it == __version_keys.end())
+	{
+		// nothing is remembered if the check throws
+		it = __version_keys.insert({ versionString, SharedPool().getVersionKey(versionString) }).first;
+	}
+	return it->second;
+}
+
+void parseLine(const char* begin, const char* end, vector< Record >& records, LocalCache& localCache)
+{
+	parseLine< LocalCache >(begin, end, records, localCache);
+}
+
+void checkLine(const char* begin, const char* end)
+{
+	forEachRelation(begin, end, [](const char* relationBegin, const char* relationEnd, bool)
+	{
+		const char* packageNameEnd;
+		Types::Type relationType;
+		const char* versionBegin;
+		const char* versionEnd;
+		splitRelation(relationBegin, relationEnd, packageNameEnd, relationType, versionBegin, versionEnd);
+		if (relationType != Types::None)
+		{
+			checkVersionString(string(versionBegin, versionEnd));
+		}
+	});
+}
+
+void buildExpression(const char* begin, const char* end, cache::RelationExpression& expression)
+{
+	vector< Record > records;
+	records.reserve(getMaxRecordCount(begin, end));
+	parseExpression(begin, end, records);
+
+	expression.reserve(records.size());
+	FORIT(recordIt, records)
+	{
+		expression.emplace_back(*recordIt);
+	}
+}
+
+void buildLine(const char* begin, const char* end, cache::RelationLine& line)
+{
+	vector< Record > records;
+	records.reserve(getMaxRecordCount(begin, end));
+	parseLine(begin, end, records);
+
+	line.reserve(std::count_if(records.begin(), records.end(),
+			[](const Record& record) { return record.isLastAlternative; }));
+	auto expressionBegin = records.begin();
+	FORIT(recordIt, records)
+	{
+		if (recordIt->isLastAlternative)
+		{
+			line.emplace_back();
+			auto& expression = line.back();
+			expression.reserve(recordIt + 1 - expressionBegin);
+			for (auto it = expressionBegin; it != recordIt + 1; ++it)
+			{
+				expression.emplace_back(*it);
+			}
+			expressionBegin = recordIt + 1;
+		}
+	}
+}
+
+void convertLine(const cache::RelationLine& line, vector< Record >& records)
+{
+	FORIT(expressionIt, line)
+	{
+		FORIT(relationIt, *expressionIt)
+		{
+			appendRecord(*relationIt, relationIt+1 == expressionIt->end(), records);
+		}
+	}
+}
+
+bool isComparisonResultSatisfying(cache::Relation::Types::Type relationType, int comparisonResult)
+{
+	switch (relationType)
+	{
+		case Types::MoreOrEqual:
+			return (comparisonResult >= 0);
+		case Types::Less:
+			return (comparisonResult < 0);
+		case Types::LessOrEqual:
+			return (comparisonResult <= 0);
+		case Types::Equal:
+			return (comparisonResult == 0);
+		case Types::More:
+			return (comparisonResult > 0);
+		case Types::None:
+			return true;
+	}
+	__builtin_unreachable();
+}
+
+bool isSatisfiedBy(const Record& record, const cache::Version& version)
+{
+	if (record.relationType == Types::None)
+	{
+		return true;
+	}
+	return isComparisonResultSatisfying(record.relationType, versionkey::compare(
+			versionkey::get(version), version.versionString, record.versionKey, *record.versionString));
+}
+
+}
+}
+}
+
@@ -0,0 +1,94 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#ifndef CUPT_INTERNAL_RELATIONPARSER_SEEN
+#define CUPT_INTERNAL_RELATIONPARSER_SEEN
+
+#include <cstdint>
+#include <unordered_map>
+
+#include <cupt/fwd.hpp>
+#include <cupt/cache/relation.hpp>
+
+#include <internal/stringpool.hpp>
+
+namespace cupt {
+namespace internal {
+
+// tokenizes relations in place over the source buffer; package names and
+// version strings are interned, so a parsed relation is a fixed-size record
+// which owns no memory, and a whole relation line is one array of them
+//
+// Relation, RelationExpression and RelationLine are built on top of this
+// parser, so records and the objects have the same contents and the same
+// expression indexes
+namespace relationparser {
+
+struct Record
+{
+	stringpool::Handle packageName;
+	stringpool::Handle versionString; // NULL if relationType is None
+	const string* versionKey; // see versionkey::get
+	cache::Relation::Types::Type relationType;
+	bool isLastAlternative; // the record ends a relation expression
+};
+
+// parses one relation, throws on errors
+void parseRelation(const char* begin, const char* end, Record& record);
+
+// appends the records of the relation expression [begin, end)
+void parseExpression(const char* begin, const char* end, vector< Record >& records);
+
+// appends the records of all relation expressions of the line [begin, end)
+// to 'records'; reusing 'records' between lines makes the parsing free of
+// allocations once the array is big enough
+void parseLine(const char* begin, const char* end, vector< Record >& records);
+// throws the errors parseLine() would throw, without interning anything
+void checkLine(const char* begin, const char* end);
+
+// what parsing in one thread reuses: the strings seen before and their
+// version keys are found without touching the shared string pool
+class LocalCache
+{
+	stringpool::LocalCache __strings;
+	std::unordered_map< stringpool::Handle, const string* > __version_keys;
+ public:
+	stringpool::Handle intern(const char* data, size_t size);
+	// checks the version string once
+	const string* getVersionKey(stringpool::Handle versionString);
+};
+// parseLine() through the local cache
+void parseLine(const char* begin, const char* end, vector< Record >& records, LocalCache&);
+
+// build the objects out of records, allocating each array once; the objects
+// should be empty
+void buildExpression(const char* begin, const char* end, cache::RelationExpression& expression);
+void buildLine(const char* begin, const char* end, cache::RelationLine& line);
+
+// appends the records of an already built line
+void convertLine(const cache::RelationLine& line, vector< Record >& records);
+
+bool isComparisonResultSatisfying(cache::Relation::Types::Type relationType, int comparisonResult);
+bool isSatisfiedBy(const Record& record, const cache::Version& version);
+
+}
+
+}
+}
+
+#endif
+
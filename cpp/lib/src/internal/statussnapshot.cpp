@@ -0,0 +1,145 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#include <cstring>
+
+#include <internal/statussnapshot.hpp>
+
+namespace cupt {
+namespace internal {
+namespace dss {
+
+namespace {
+
+const pf::Format format = { { 'c', 'u', 'p', 't', '-', 'd', 's', 's' }, 1 };
+
+struct Header
+{
+	uint32_t recordCount;
+	uint32_t stringPoolSize;
+};
+
+struct StoredRecord
+{
+	uint64_t offset;
+	uint32_t nameStart;
+	uint32_t nameSize;
+	uint32_t providesStart;
+	uint32_t providesSize;
+	uint8_t hasVersion;
+	uint8_t want;
+	uint8_t flag;
+	uint8_t status;
+	uint32_t padding;
+};
+
+}
+
+bool read(const string& snapshotPath, const pf::Signature& statusSignature, vector< Record >& records)
+{
+	pf::Reader reader(snapshotPath, format, statusSignature);
+	auto data = reader.getBody();
+	if (!reader.isValid() || reader.getBodySize() < sizeof(Header))
+	{
+		return false;
+	}
+
+	Header header;
+	memcpy(&header, data, sizeof(header));
+	if (reader.getBodySize() != sizeof(Header) +
+			uint64_t(header.recordCount) * sizeof(StoredRecord) + header.stringPoolSize)
+	{
+		return false; // truncated
+	}
+
+	auto storedRecords = reinterpret_cast< const StoredRecord* >(data + sizeof(Header));
+	auto stringPool = data + sizeof(Header) + header.recordCount * sizeof(StoredRecord);
+	auto isInPool = [&header](uint32_t start, uint32_t size)
+	{
+		return uint64_t(start) + size <= header.stringPoolSize;
+	};
+
+	records.clear();
+	records.resize(header.recordCount);
+	for (uint32_t i = 0; i < header.recordCount; ++i)
+	{
+		const StoredRecord& storedRecord = storedRecords[i];
+		if (!isInPool(storedRecord.nameStart, storedRecord.nameSize) ||
+				!isInPool(storedRecord.providesStart, storedRecord.providesSize) ||
+				storedRecord.want >= Record::InstalledRecord::Want::Count ||
+				storedRecord.flag >= Record::InstalledRecord::Flag::Count ||
+				storedRecord.status >= Record::InstalledRecord::Status::Count)
+		{
+			records.clear();
+			return false;
+		}
+		Record& record = records[i];
+		record.packageName.assign(stringPool + storedRecord.nameStart, storedRecord.nameSize);
+		record.hasVersion = storedRecord.hasVersion;
+		record.want = Record::InstalledRecord::Want::Type(storedRecord.want);
+		record.flag = Record::InstalledRecord::Flag::Type(storedRecord.flag);
+		record.status = Record::InstalledRecord::Status::Type(storedRecord.status);
+		record.offset = storedRecord.offset;
+		record.provides.assign(stringPool + storedRecord.providesStart, storedRecord.providesSize);
+	}
+
+	return true;
+}
+
+void write(const string& snapshotPath, const pf::Signature& statusSignature, const vector< Record >& records)
+{
+	Header header;
+	header.recordCount = records.size();
+
+	vector< StoredRecord > storedRecords;
+	storedRecords.reserve(records.size());
+	string stringPool;
+	FORIT(recordIt, records)
+	{
+		StoredRecord storedRecord;
+		memset(&storedRecord, 0, sizeof(storedRecord));
+		storedRecord.offset = recordIt->offset;
+		storedRecord.nameStart = stringPool.size();
+		storedRecord.nameSize = recordIt->packageName.size();
+		stringPool += recordIt->packageName;
+		storedRecord.providesStart = stringPool.size();
+		storedRecord.providesSize = recordIt->provides.size();
+		stringPool += recordIt->provides;
+		storedRecord.hasVersion = recordIt->hasVersion;
+		storedRecord.want = recordIt->want;
+		storedRecord.flag = recordIt->flag;
+		storedRecord.status = recordIt->status;
+		storedRecords.push_back(storedRecord);
+	}
+	header.stringPoolSize = stringPool.size();
+
+	pf::write(snapshotPath, format, statusSignature, [&header, &storedRecords, &stringPool](pf::Writer& writer)
+	{
+		writer.put(reinterpret_cast< const char* >(&header), sizeof(header));
+		if (!storedRecords.empty())
+		{
+			writer.put(reinterpret_cast< const char* >(&storedRecords[0]),
+					storedRecords.size() * sizeof(StoredRecord));
+		}
+		writer.put(stringPool);
+	});
+}
+
+}
+}
+}
+
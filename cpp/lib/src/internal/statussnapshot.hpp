@@ -0,0 +1,61 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#ifndef CUPT_INTERNAL_STATUSSNAPSHOT_SEEN
+#define CUPT_INTERNAL_STATUSSNAPSHOT_SEEN
+
+#include <cupt/common.hpp>
+#include <cupt/system/state.hpp>
+
+#include <internal/persistentfile.hpp>
+
+namespace cupt {
+namespace internal {
+
+// "dpkg status snapshot": a persistent binary digest of the dpkg status file
+// which contains what the package cache needs from it (package names,
+// statuses, record offsets and provides), so the status file doesn't have to
+// be parsed on every cache construction
+namespace dss {
+
+struct Record
+{
+	typedef system::State::InstalledRecord InstalledRecord;
+
+	string packageName;
+	bool hasVersion; // if not, other fields except the package name are meaningless
+	InstalledRecord::Want::Type want;
+	InstalledRecord::Flag::Type flag;
+	InstalledRecord::Status::Type status;
+	uint64_t offset; // of the record
+	string provides; // empty means 'no provides'
+};
+
+// returns false if the snapshot doesn't exist, is damaged or was made for
+// a status file with another signature
+bool read(const string& snapshotPath, const pf::Signature& statusSignature, vector< Record >&);
+// the caller has to hold the lists lock; errors are silently ignored, the
+// snapshot will be made next time again
+void write(const string& snapshotPath, const pf::Signature& statusSignature, const vector< Record >&);
+
+}
+
+}
+}
+
+#endif
+
@@ -0,0 +1,160 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#include <cstring>
+#include <deque>
+#include <mutex>
+
+#include <internal/stringpool.hpp>
+
+namespace cupt {
+namespace internal {
+namespace stringpool {
+
+namespace {
+
+size_t hashString(const char* data, size_t size)
+{
+	// FNV-1a
+	size_t result = 2166136261u;
+	for (size_t i = 0; i < size; ++i)
+	{
+		result = (result ^ (unsigned char)data[i]) * 16777619u;
+	}
+	return result;
+}
+
+// hash tables of handles use open addressing with linear probing, their sizes
+// are powers of two; lookups don't construct strings
+
+// the position of the string or of the empty slot where it should go
+size_t findPosition(const vector< Handle >& table, size_t hash, const char* data, size_t size)
+{
+	size_t mask = table.size() - 1;
+	size_t position = hash & mask;
+	while (table[position])
+	{
+		const string& candidate = *table[position];
+		if (candidate.size() == size && !memcmp(candidate.data(), data, size))
+		{
+			break;
+		}
+		position = (position + 1) & mask;
+	}
+	return position;
+}
+
+// adds a handle which is not in the table yet, keeping the table at most half full
+void insert(vector< Handle >& table, size_t& count, size_t position, Handle handle)
+{
+	table[position] = handle;
+	if ((++count) * 2 <= table.size())
+	{
+		return;
+	}
+
+	vector< Handle > newTable(table.size() * 2, NULL);
+	FORIT(handleIt, table)
+	{
+		if (*handleIt)
+		{
+			const string& value = **handleIt;
+			newTable[findPosition(newTable, hashString(value.data(), value.size()),
+					value.data(), value.size())] = *handleIt;
+		}
+	}
+	table.swap(newTable);
+}
+
+class Shard
+{
+	std::deque< string > __storage; // stable addresses
+	vector< Handle > __table;
+	size_t __count;
+	std::mutex __mutex;
+ public:
+	Shard()
+		: __table(1 << 10, NULL), __count(0)
+	{}
+
+	Handle intern(size_t hash, const char* data, size_t size)
+	{
+		std::lock_guard< std::mutex > lock(__mutex);
+
+		size_t position = findPosition(__table, hash, data, size);
+		if (__table[position])
+		{
+			return __table[position];
+		}
+
+		__storage.push_back(string(data, size));
+		Handle result = &__storage.back();
+		insert(__table, __count, position, result);
+		return result;
+	}
+
+	Handle find(size_t hash, const char* data, size_t size)
+	{
+		std::lock_guard< std::mutex > lock(__mutex);
+		return __table[findPosition(__table, hash, data, size)];
+	}
+};
+
+const size_t shardCountBits = 6;
+
+Shard& getShard(size_t hash)
+{
+	static Shard shards[1 << shardCountBits];
+	// the low bits pick the slot inside the shard, so the shard is picked by
+	// the high bits of a remixed hash
+	return shards[(uint64_t(hash) * 0x9E3779B97F4A7C15ull) >> (64 - shardCountBits)];
+}
+
+}
+
+Handle intern(const char* data, size_t size)
+{
+	size_t hash = hashString(data, size);
+	return getShard(hash).intern(hash, data, size);
+}
+
+Handle find(const char* data, size_t size)
+{
+	size_t hash = hashString(data, size);
+	return getShard(hash).find(hash, data, size);
+}
+
+LocalCache::LocalCache()
+	: __table(1 << 10, NULL), __count(0)
+{}
+
+Handle LocalCache::intern(const char* data, size_t size)
+{
+	size_t hash = hashString(data, size);
+	size_t position = findPosition(__table, hash, data, size);
+	if (!__table[position])
+	{
+		insert(__table, __count, position, getShard(hash).intern(hash, data, size));
+		position = findPosition(__table, hash, data, size);
+	}
+	return __table[position];
+}
+
+}
+}
+}
+
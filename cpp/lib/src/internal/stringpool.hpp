@@ -0,0 +1,75 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#ifndef CUPT_INTERNAL_STRINGPOOL_SEEN
+#define CUPT_INTERNAL_STRINGPOOL_SEEN
+
+#include <cupt/common.hpp>
+
+namespace cupt {
+namespace internal {
+
+// process-wide pool of the strings which internal indexes are keyed by
+// (package names and version strings of relations, provides); pooled strings
+// live until the process ends, so their addresses are stable handles: two
+// strings are equal if and only if their handles are equal
+//
+// the pool is split into shards with a lock each, so threads interning
+// different strings rarely wait for each other
+namespace stringpool {
+
+typedef const string* Handle;
+
+Handle intern(const char* data, size_t size);
+
+// doesn't add the string; NULL if it is not pooled, so nothing can be keyed
+// by it
+Handle find(const char* data, size_t size);
+
+inline Handle find(const string& s)
+{
+	return find(s.data(), s.size());
+}
+
+inline Handle intern(const string& s)
+{
+	return intern(s.data(), s.size());
+}
+
+inline Handle intern(string::const_iterator begin, string::const_iterator end)
+{
+	return (begin != end) ? intern(&*begin, end - begin) : intern("", 0);
+}
+
+// a front of the pool for one thread: the strings interned through it before
+// are found without touching the shared pool and its locks
+class LocalCache
+{
+	vector< Handle > __table;
+	size_t __count;
+ public:
+	LocalCache();
+	Handle intern(const char* data, size_t size);
+};
+
+}
+
+}
+}
+
+#endif
+
@@ -26,14 +26,34 @@ namespace cupt {
 namespace internal {
 
 TagParser::TagParser(File* input)
-	: __input(input), __buffer(NULL)
+	: __input(input), __buffer(NULL), __memory_position(NULL), __memory_end(NULL)
 {}
 
+TagParser::TagParser(const char* begin, const char* end)
+	: __input(NULL), __buffer(NULL), __memory_position(begin), __memory_end(end)
+{}
+
+void TagParser::__get_line()
+{
+	if (__input)
+	{
+		__input->rawGetLine(__buffer, __buffer_size);
+	}
+	else
+	{
+		__buffer = __memory_position;
+		auto newLinePosition = static_cast< const char* >(
+				memchr(__memory_position, '\n', __memory_end - __memory_position));
+		__memory_position = newLinePosition ? newLinePosition + 1 : __memory_end;
+		__buffer_size = __memory_position - __buffer;
+	}
+}
+
 bool TagParser::parseNextLine(StringRange& tagName, StringRange& tagValue)
 {
 	if (!__buffer)
 	{
-		__input->rawGetLine(__buffer, __buffer_size);
+		__get_line();
 	}
 
 	do
@@ -44,7 +64,7 @@ bool TagParser::parseNextLine(StringRange& tagName, StringRange& tagValue)
 			return false;
 		}
 		// if line starts with a blank character, get new line and restart the loop
-	} while (isblank(__buffer[0]) && (__input->rawGetLine(__buffer, __buffer_size), true));
+	} while (isblank(__buffer[0]) && (__get_line(), true));
 
 	{ // ok, first line is ready
 		// chopping last '\n' if present
@@ -62,11 +82,12 @@ bool TagParser::parseNextLine(StringRange& tagName, StringRange& tagValue)
 		tagName.second = decltype(tagName.second)((const char*)colonPosition);
 		// getting tag value on a first line
 		tagValue.first = decltype(tagValue.first)((const char*)colonPosition+1);
-		if (isblank(*tagValue.first))
+		tagValue.second = decltype(tagValue.second)(__buffer + __buffer_size);
+		// the buffer may be a memory mapping, so don't look past the line
+		if (tagValue.first != tagValue.second && isblank(*tagValue.first))
 		{
 			++tagValue.first;
 		}
-		tagValue.second = decltype(tagValue.second)(__buffer + __buffer_size);
 	}
 	__buffer = NULL;
 	return true;
@@ -76,12 +97,28 @@ void TagParser::parseAdditionalLines(string& lines)
 {
 	// now let's see if there are any additional lines for the tag
 	lines.clear();
-	while (__input->rawGetLine(__buffer, __buffer_size), (__buffer_size > 1 && isblank(__buffer[0])))
+	while (__get_line(), (__buffer_size > 1 && isblank(__buffer[0])))
 	{
 		lines.append(__buffer, __buffer_size);
 	}
 }
 
+void TagParser::parseAdditionalLines(StringRange& lines)
+{
+	const char* begin = NULL;
+	const char* end = NULL;
+	while (__get_line(), (__buffer_size > 1 && isblank(__buffer[0])))
+	{
+		if (!begin)
+		{
+			begin = __buffer;
+		}
+		end = __buffer + __buffer_size;
+	}
+	lines.first = decltype(lines.first)(begin);
+	lines.second = decltype(lines.second)(end);
+}
+
 }
 }
 
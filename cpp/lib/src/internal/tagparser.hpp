@@ -47,16 +47,25 @@ class TagParser
 	File* const __input;
 	const char* __buffer;
 	size_t __buffer_size;
+	const char* __memory_position;
+	const char* __memory_end;
 
 	TagParser(const TagParser&);
 	TagParser& operator=(const TagParser&);
+	void __get_line();
  public:
 	TagParser(File* input);
+	// parses the record text in [begin, end)
+	TagParser(const char* begin, const char* end);
 
 	bool parseNextLine(StringRange& tagName, StringRange& tagValue);
 	// forbidden to call more than once for one tag, since one line
 	// (buffer) will be lost between
 	void parseAdditionalLines(string& lines);
+	// the same, but returns the raw range of the lines instead of copying
+	// them; may be used only if lines are adjacent in memory, that is, when
+	// parsing a memory-mapped file or a text in memory
+	void parseAdditionalLines(StringRange& lines);
 };
 
 }
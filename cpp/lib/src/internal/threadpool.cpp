@@ -0,0 +1,178 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#include <algorithm>
+
+#include <internal/threadpool.hpp>
+
+namespace cupt {
+namespace internal {
+namespace threadpool {
+
+namespace {
+
+ssize_t getEffectiveThreadCount(ssize_t threadCount)
+{
+	if (threadCount <= 0)
+	{
+		threadCount = std::thread::hardware_concurrency();
+	}
+	return threadCount;
+}
+
+}
+
+ThreadPool::ThreadPool(ssize_t threadCount)
+	: __task(NULL), __task_count(0), __next_task_index(0), __unfinished_task_count(0),
+	__batch_number(0), __stopping(false)
+{
+	threadCount = getEffectiveThreadCount(threadCount);
+	for (ssize_t threadIndex = 1; threadIndex < threadCount; ++threadIndex)
+	{
+		__threads.push_back(std::thread([this]() { this->__thread_loop(); }));
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard< std::mutex > lock(__mutex);
+		__stopping = true;
+	}
+	__batch_started.notify_all();
+	FORIT(threadIt, __threads)
+	{
+		threadIt->join();
+	}
+}
+
+size_t ThreadPool::getThreadCount() const
+{
+	return __threads.size() + 1;
+}
+
+void ThreadPool::__run_tasks(std::unique_lock< std::mutex >& lock)
+{
+	while (__next_task_index < __task_count)
+	{
+		size_t taskIndex = __next_task_index++;
+		const Task& task = *__task;
+
+		lock.unlock();
+		std::exception_ptr error;
+		try
+		{
+			task(taskIndex);
+		}
+		catch (...)
+		{
+			error = std::current_exception();
+		}
+		lock.lock();
+
+		if (error && !__unexpected_error)
+		{
+			__unexpected_error = error;
+		}
+		if (--__unfinished_task_count == 0)
+		{
+			__batch_finished.notify_all();
+		}
+	}
+}
+
+void ThreadPool::__thread_loop()
+{
+	std::unique_lock< std::mutex > lock(__mutex);
+	size_t lastBatchNumber = 0;
+	while (true)
+	{
+		__batch_started.wait(lock, [this, lastBatchNumber]()
+		{
+			return this->__stopping || this->__batch_number != lastBatchNumber;
+		});
+		if (__stopping)
+		{
+			return;
+		}
+		lastBatchNumber = __batch_number;
+		__run_tasks(lock);
+	}
+}
+
+void ThreadPool::run(size_t taskCount, const Task& task)
+{
+	if (__threads.empty() || taskCount <= 1)
+	{
+		// the same as below: all tasks run, the first error is rethrown
+		std::exception_ptr firstError;
+		for (size_t taskIndex = 0; taskIndex < taskCount; ++taskIndex)
+		{
+			try
+			{
+				task(taskIndex);
+			}
+			catch (...)
+			{
+				if (!firstError)
+				{
+					firstError = std::current_exception();
+				}
+			}
+		}
+		if (firstError)
+		{
+			std::rethrow_exception(firstError);
+		}
+		return;
+	}
+
+	std::unique_lock< std::mutex > lock(__mutex);
+	__task = &task;
+	__task_count = taskCount;
+	__next_task_index = 0;
+	__unfinished_task_count = taskCount;
+	++__batch_number;
+	__batch_started.notify_all();
+
+	__run_tasks(lock);
+	__batch_finished.wait(lock, [this]() { return this->__unfinished_task_count == 0; });
+	__task = NULL;
+	__task_count = 0;
+
+	if (__unexpected_error)
+	{
+		auto error = __unexpected_error;
+		__unexpected_error = std::exception_ptr();
+		std::rethrow_exception(error);
+	}
+}
+
+void ThreadPool::runOnce(size_t taskCount, ssize_t threadCount, const Task& task)
+{
+	if (taskCount == 0)
+	{
+		return; // ThreadPool(0) would start a thread per processor
+	}
+	threadCount = std::min(getEffectiveThreadCount(threadCount), ssize_t(taskCount));
+	ThreadPool(threadCount).run(taskCount, task);
+}
+
+}
+}
+}
+
@@ -0,0 +1,80 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#ifndef CUPT_INTERNAL_THREADPOOL_SEEN
+#define CUPT_INTERNAL_THREADPOOL_SEEN
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include <cupt/common.hpp>
+
+namespace cupt {
+namespace internal {
+
+// threads which are started once and then run many short batches of tasks,
+// for the callers which can't afford starting threads for every batch
+namespace threadpool {
+
+class ThreadPool
+{
+	typedef std::function< void (size_t) > Task;
+
+	std::mutex __mutex;
+	std::condition_variable __batch_started;
+	std::condition_variable __batch_finished;
+	vector< std::thread > __threads;
+
+	const Task* __task; // of the current batch
+	size_t __task_count;
+	size_t __next_task_index;
+	size_t __unfinished_task_count;
+	size_t __batch_number;
+	bool __stopping;
+	std::exception_ptr __unexpected_error;
+
+	void __run_tasks(std::unique_lock< std::mutex >&);
+	void __thread_loop();
+
+	ThreadPool(const ThreadPool&);
+	ThreadPool& operator=(const ThreadPool&);
+ public:
+	// 'threadCount' counts the calling thread, which takes part in every
+	// batch too; 'threadCount' <= 0 means 'the number of available processors'
+	explicit ThreadPool(ssize_t threadCount);
+	~ThreadPool();
+
+	size_t getThreadCount() const;
+	// runs task(0), ..., task(taskCount-1) and returns when all of them are
+	// done; the first exception thrown by a task is rethrown here
+	void run(size_t taskCount, const Task& task);
+
+	// the same for a single batch: starts no more threads than there are
+	// tasks and stops them before returning
+	static void runOnce(size_t taskCount, ssize_t threadCount, const Task& task);
+};
+
+}
+
+}
+}
+
+#endif
+
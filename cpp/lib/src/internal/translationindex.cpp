@@ -0,0 +1,267 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#include <cstring>
+#include <algorithm>
+
+#include <internal/translationindex.hpp>
+#include <internal/mappedfile.hpp>
+#include <internal/persistentfile.hpp>
+#include <internal/tagparser.hpp>
+
+namespace cupt {
+namespace internal {
+namespace tri {
+
+namespace {
+
+const pf::Format format = { { 'c', 'u', 'p', 't', '-', 't', 'r', 'i' }, 1 };
+
+// the size is a multiple of 8, so records following it are aligned
+struct Header
+{
+	uint64_t recordCount;
+};
+
+inline int getHexDigitValue(char c)
+{
+	if (c >= '0' && c <= '9')
+	{
+		return c - '0';
+	}
+	if (c >= 'a' && c <= 'f')
+	{
+		return c - 'a' + 10;
+	}
+	if (c >= 'A' && c <= 'F')
+	{
+		return c - 'A' + 10;
+	}
+	return -1;
+}
+
+}
+
+bool parseDigest(const char* begin, const char* end, Digest& digest)
+{
+	if (end - begin != 2 * sizeof(digest.bytes))
+	{
+		return false;
+	}
+	for (size_t i = 0; i < sizeof(digest.bytes); ++i)
+	{
+		int high = getHexDigitValue(begin[2*i]);
+		int low = getHexDigitValue(begin[2*i+1]);
+		if (high < 0 || low < 0)
+		{
+			return false;
+		}
+		digest.bytes[i] = (high << 4) | low;
+	}
+	return true;
+}
+
+string getTranslationIndexPath(const string& translationPath)
+{
+	return translationPath + ".tri";
+}
+
+Index::Index(const string& translationPath, const string& alias,
+		bool usePersistentIndex, bool writePersistentIndex)
+	: __begin(NULL), __end(NULL)
+{
+	if (usePersistentIndex && __read_persistent(translationPath))
+	{
+		return;
+	}
+
+	pf::Signature translationSignature;
+	bool writing = usePersistentIndex && writePersistentIndex &&
+			pf::getSignature(translationPath, translationSignature);
+	__build(translationPath, alias, usePersistentIndex && writePersistentIndex);
+	if (writing)
+	{
+		__write_persistent(translationPath, translationSignature);
+	}
+}
+
+Index::~Index()
+{}
+
+bool Index::__read_persistent(const string& translationPath)
+{
+	pf::Signature translationSignature;
+	if (!pf::getSignature(translationPath, translationSignature))
+	{
+		return false;
+	}
+
+	std::unique_ptr< pf::Reader > reader(
+			new pf::Reader(getTranslationIndexPath(translationPath), format, translationSignature));
+	auto data = reader->getBody();
+	if (!reader->isValid() || reader->getBodySize() < sizeof(Header))
+	{
+		return false;
+	}
+
+	Header header;
+	memcpy(&header, data, sizeof(header));
+	if (reader->getBodySize() != sizeof(Header) + header.recordCount * sizeof(Record))
+	{
+		return false; // truncated
+	}
+
+	__begin = reinterpret_cast< const Record* >(data + sizeof(Header));
+	__end = __begin + header.recordCount;
+	__reader = std::move(reader);
+	return true;
+}
+
+// the translation may be mapped only while the lists lock is held
+void Index::__build(const string& translationPath, const string& alias, bool mayMap)
+{
+	string openError;
+	MappedFile mappedFile(translationPath,
+			mayMap ? MappedFile::Access::Map : MappedFile::Access::Read, &openError);
+	if (!openError.empty())
+	{
+		fatal2(__("unable to open the file '%s': %s"), translationPath, openError);
+	}
+
+	try
+	{
+		const char* const begin = mappedFile.data();
+		const char* const end = begin + mappedFile.size();
+		TagParser::StringRange tagName, tagValue;
+
+		static const char descriptionSubPattern[] = "Description-";
+		static const size_t descriptionSubPatternSize = sizeof(descriptionSubPattern) - 1;
+		static const char recordSeparator[] = "\n\n";
+
+		const char* recordBegin = begin;
+		while (recordBegin != end)
+		{
+			if (*recordBegin == '\n')
+			{
+				++recordBegin; // extra empty line
+				continue;
+			}
+			const char* recordEnd = std::search(recordBegin, end,
+					recordSeparator, recordSeparator + sizeof(recordSeparator) - 1);
+			recordEnd = (recordEnd == end) ? end : recordEnd + 2;
+			TagParser parser(recordBegin, recordEnd);
+			const char* recordPosition = recordBegin;
+			recordBegin = recordEnd;
+			if (!parser.parseNextLine(tagName, tagValue))
+			{
+				continue;
+			}
+
+			bool hashSumFound = false;
+			bool hashSumIsValid = false;
+			bool translationFound = false;
+			Record record;
+
+			do
+			{
+				if (tagName.equal(BUFFER_AND_SIZE("Description-md5")))
+				{
+					hashSumFound = true;
+					hashSumIsValid = parseDigest(&*tagValue.first, &*tagValue.second, record.digest);
+				}
+				else if ((size_t)(tagName.second - tagName.first) > descriptionSubPatternSize &&
+						!memcmp(&*tagName.first, descriptionSubPattern, descriptionSubPatternSize))
+				{
+					translationFound = true;
+					record.offset = &*tagValue.first - begin;
+				}
+			} while (parser.parseNextLine(tagName, tagValue));
+
+			if (!hashSumFound)
+			{
+				fatal2(__("unable to find the md5 hash in the record starting at byte '%u'"),
+						recordPosition - begin);
+			}
+			if (!translationFound)
+			{
+				fatal2(__("unable to find the translation in the record starting at byte '%u'"),
+						recordPosition - begin);
+			}
+
+			if (hashSumIsValid) // otherwise no description can match it
+			{
+				__records.push_back(record);
+			}
+		}
+	}
+	catch (Exception&)
+	{
+		fatal2(__("unable to parse the index '%s'"), alias);
+	}
+
+	// stable: the first translation of the same description wins
+	std::stable_sort(__records.begin(), __records.end(),
+			[](const Record& left, const Record& right)
+			{
+				return memcmp(left.digest.bytes, right.digest.bytes, sizeof(left.digest.bytes)) < 0;
+			});
+	__begin = __records.empty() ? NULL : &__records[0];
+	__end = __begin + __records.size();
+}
+
+// 'translationSignature' is the one taken before building, the translation
+// index is not written if the Translation file was changed since then
+void Index::__write_persistent(const string& translationPath, const pf::Signature& translationSignature) const
+{
+	pf::Signature currentTranslationSignature;
+	if (!pf::getSignature(translationPath, currentTranslationSignature) ||
+			!(currentTranslationSignature == translationSignature))
+	{
+		return;
+	}
+	Header header;
+	header.recordCount = __records.size();
+
+	pf::write(getTranslationIndexPath(translationPath), format, translationSignature,
+			[this, &header](pf::Writer& writer)
+			{
+				writer.put(reinterpret_cast< const char* >(&header), sizeof(header));
+				if (!__records.empty())
+				{
+					writer.put(reinterpret_cast< const char* >(&__records[0]), __records.size() * sizeof(Record));
+				}
+			});
+}
+
+ssize_t Index::find(const Digest& digest) const
+{
+	auto it = std::lower_bound(__begin, __end, digest,
+			[](const Record& record, const Digest& digest)
+			{
+				return memcmp(record.digest.bytes, digest.bytes, sizeof(digest.bytes)) < 0;
+			});
+	if (it != __end && !memcmp(it->digest.bytes, digest.bytes, sizeof(digest.bytes)))
+	{
+		return it->offset;
+	}
+	return -1;
+}
+
+}
+}
+}
+
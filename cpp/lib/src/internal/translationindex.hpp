@@ -0,0 +1,91 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#ifndef CUPT_INTERNAL_TRANSLATIONINDEX_SEEN
+#define CUPT_INTERNAL_TRANSLATIONINDEX_SEEN
+
+#include <memory>
+
+#include <cupt/common.hpp>
+
+namespace cupt {
+namespace internal {
+
+namespace pf {
+
+class Reader;
+struct Signature;
+
+}
+
+// "translation index": a persistent table of binary MD5 digests of original
+// descriptions and offsets of their translations in a Translation-* file,
+// sorted by digest, so the Translation file itself doesn't have to be parsed
+// on every lookup
+namespace tri {
+
+struct Digest
+{
+	uint8_t bytes[16];
+};
+
+// returns false if the range doesn't contain exactly 32 hexadecimal digits
+bool parseDigest(const char* begin, const char* end, Digest&);
+
+string getTranslationIndexPath(const string& translationPath);
+
+class Index
+{
+	struct Record
+	{
+		Digest digest;
+		uint64_t offset;
+	};
+
+	std::unique_ptr< pf::Reader > __reader;
+	vector< Record > __records;
+	const Record* __begin;
+	const Record* __end;
+
+	bool __read_persistent(const string& translationPath);
+	void __build(const string& translationPath, const string& alias, bool mayMap);
+	void __write_persistent(const string& translationPath, const pf::Signature&) const;
+
+	Index(const Index&);
+	Index& operator=(const Index&);
+ public:
+	// reads the valid translation index or builds it from the Translation
+	// file; in the latter case the translation index is (re)generated if both
+	// 'usePersistentIndex' and 'writePersistentIndex' are true, the caller has
+	// to hold the lists lock then
+	Index(const string& translationPath, const string& alias,
+			bool usePersistentIndex, bool writePersistentIndex);
+	~Index();
+
+	// returns the offset of the translation of the description with this
+	// digest (the start of its first line), or -1 if there is no translation;
+	// if the Translation file has several, the first one is returned
+	ssize_t find(const Digest&) const;
+};
+
+}
+
+}
+}
+
+#endif
+
@@ -0,0 +1,255 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#include <cstring>
+
+#include <internal/versionkey.hpp>
+#include <internal/stringpool.hpp>
+
+namespace cupt {
+namespace internal {
+namespace versionkey {
+
+namespace {
+
+const char tildeByte = '\x01';
+const char partEndByte = '\x02';
+const char runEndByte = '\x03';
+
+inline bool isDigit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+inline bool isLetter(char c)
+{
+	return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+}
+
+// builds keys of usual version strings without allocations; a character
+// of a version string takes at most 4 bytes of the key (a digit run of one
+// character), plus the epoch, the part ends and an implicit revision
+class StackKey
+{
+	char __data[256];
+	size_t __size;
+ public:
+	static const size_t maxVersionStringSize = (sizeof(__data) - 16) / 4;
+
+	StackKey()
+		: __size(0)
+	{}
+	void operator+=(char c)
+	{
+		__data[__size++] = c;
+	}
+	void append(const char* data, size_t size)
+	{
+		memcpy(__data + __size, data, size);
+		__size += size;
+	}
+	const char* data() const
+	{
+		return __data;
+	}
+	size_t size() const
+	{
+		return __size;
+	}
+};
+
+template < typename Key >
+bool appendNumber(const char* begin, const char* end, Key& key)
+{
+	size_t length = end - begin;
+	if (length > 0xFFFF)
+	{
+		return false;
+	}
+	key += char(length >> 8);
+	key += char(length & 0xFF);
+	key.append(begin, end - begin);
+	return true;
+}
+
+template < typename Key >
+bool appendPart(const char* current, const char* end, Key& key)
+{
+	while (true)
+	{
+		for (; current != end && !isDigit(*current); ++current)
+		{
+			char c = *current;
+			if (c & 0x80)
+			{
+				return false;
+			}
+			if (c == '~')
+			{
+				key += tildeByte;
+			}
+			else if (isLetter(c))
+			{
+				key += c;
+			}
+			else
+			{
+				key += char(c | 0x80);
+			}
+		}
+		if (current == end)
+		{
+			break;
+		}
+		key += runEndByte;
+
+		while (current != end && *current == '0')
+		{
+			++current;
+		}
+		auto numberBegin = current;
+		while (current != end && isDigit(*current))
+		{
+			++current;
+		}
+		if (!appendNumber(numberBegin, current, key))
+		{
+			return false;
+		}
+		if (current == end)
+		{
+			break;
+		}
+	}
+	key += partEndByte;
+	return true;
+}
+
+template < typename Key >
+bool makeKey(const string& versionString, Key& key)
+{
+	const char* begin = versionString.data();
+	const char* end = begin + versionString.size();
+
+	// split as compareVersionStrings() does
+	auto colonPosition = versionString.find(':');
+	const char* upstreamBegin = (colonPosition != string::npos) ? begin + colonPosition + 1 : begin;
+	auto dashPosition = versionString.rfind('-');
+	const char* upstreamEnd = (dashPosition != string::npos) ? begin + dashPosition : end;
+	if (upstreamEnd < upstreamBegin)
+	{
+		return false;
+	}
+
+	uint32_t epoch = 0;
+	if (upstreamBegin != begin)
+	{
+		uint64_t value = 0;
+		for (const char* current = begin; current != upstreamBegin - 1; ++current)
+		{
+			if (!isDigit(*current) || (value = value * 10 + (*current - '0')) > 0xFFFFFFFFu)
+			{
+				return false;
+			}
+		}
+		epoch = value;
+	}
+	for (int shift = 24; shift >= 0; shift -= 8)
+	{
+		key += char((epoch >> shift) & 0xFF);
+	}
+
+	if (!appendPart(upstreamBegin, upstreamEnd, key))
+	{
+		return false;
+	}
+	if (upstreamEnd == end || upstreamEnd + 1 == end)
+	{
+		static const char zeroRevision[] = "0";
+		return appendPart(zeroRevision, zeroRevision + 1, key);
+	}
+	else
+	{
+		return appendPart(upstreamEnd + 1, end, key);
+	}
+}
+
+}
+
+const string* get(const string& versionString)
+{
+	if (versionString.size() <= StackKey::maxVersionStringSize)
+	{
+		StackKey key;
+		if (!makeKey(versionString, key))
+		{
+			return NULL;
+		}
+		return stringpool::intern(key.data(), key.size());
+	}
+	else
+	{
+		string key;
+		if (!makeKey(versionString, key))
+		{
+			return NULL;
+		}
+		return stringpool::intern(key);
+	}
+}
+
+void set(cache::Version& version)
+{
+	const string& versionString = version.versionString;
+	string& storage = Access::getStorage(version);
+	storage.clear();
+	if (versionString.size() <= StackKey::maxVersionStringSize)
+	{
+		StackKey key;
+		if (makeKey(versionString, key))
+		{
+			storage.assign(key.data(), key.size());
+		}
+	}
+	else if (!makeKey(versionString, storage))
+	{
+		storage.clear();
+	}
+}
+
+int compare(const string* leftKey, const string& leftVersionString,
+		const string* rightKey, const string& rightVersionString)
+{
+	if (leftKey && rightKey)
+	{
+		return (leftKey == rightKey) ? 0 : leftKey->compare(*rightKey);
+	}
+	else
+	{
+		return compareVersionStrings(leftVersionString, rightVersionString);
+	}
+}
+
+int compare(const cache::Version& left, const cache::Version& right)
+{
+	return compare(get(left), left.versionString, get(right), right.versionString);
+}
+
+}
+}
+}
+
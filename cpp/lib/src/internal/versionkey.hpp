@@ -0,0 +1,77 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#ifndef CUPT_INTERNAL_VERSIONKEY_SEEN
+#define CUPT_INTERNAL_VERSIONKEY_SEEN
+
+#include <cupt/common.hpp>
+#include <cupt/cache/version.hpp>
+
+namespace cupt {
+namespace internal {
+
+// a version string converted to a byte string which sorts by plain memcmp
+// (shorter first on a common prefix) exactly as compareVersionStrings()
+// sorts the version strings
+//
+// epoch, upstream and revision are split once; digit runs are stored as the
+// length and the digits without leading zeroes, other characters are
+// remapped so that '~' goes first, then the end of the version part, then the
+// end of a non-digit run, then letters, then everything else
+//
+// keys of version strings are pooled (see stringpool), so equal keys have
+// equal addresses; keys of parsed versions are kept in the versions
+namespace versionkey {
+
+// NULL if the version string is not representable (it is malformed or has
+// non-ASCII characters), use compareVersionStrings() for it then
+const string* get(const string& versionString);
+
+struct Access
+{
+	static const string* get(const cache::Version& version)
+	{
+		return version.__version_key.empty() ? NULL : &version.__version_key;
+	}
+	static string& getStorage(cache::Version& version)
+	{
+		return version.__version_key;
+	}
+};
+
+// the key of a parsed version, NULL for versions created otherwise
+inline const string* get(const cache::Version& version)
+{
+	return Access::get(version);
+}
+
+// computes the key of a parsed version, its version string doesn't change
+// afterwards
+void set(cache::Version&);
+
+// like compareVersionStrings(), but uses the keys when both have them
+int compare(const cache::Version&, const cache::Version&);
+int compare(const string* leftKey, const string& leftVersionString,
+		const string* rightKey, const string& rightVersionString);
+
+}
+
+}
+}
+
+#endif
+
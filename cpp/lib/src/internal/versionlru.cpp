@@ -0,0 +1,202 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#include <cstring>
+#include <iterator>
+
+#include <cupt/cache/binaryversion.hpp>
+#include <cupt/cache/sourceversion.hpp>
+
+#include <internal/versionlru.hpp>
+
+namespace cupt {
+namespace internal {
+namespace lru {
+
+namespace {
+
+// a rough estimate of what parsed versions take; strings like package names
+// and version strings are assumed to be shared
+
+size_t estimateValueSize(const string& value)
+{
+	return value.size();
+}
+
+size_t estimateValueSize(const vector< string >& value)
+{
+	size_t result = value.capacity() * sizeof(string);
+	FORIT(it, value)
+	{
+		result += it->size();
+	}
+	return result;
+}
+
+size_t estimateValueSize(const cache::RelationLine& value)
+{
+	size_t result = value.capacity() * sizeof(cache::RelationExpression);
+	FORIT(expressionIt, value)
+	{
+		result += expressionIt->capacity() * sizeof(cache::Relation);
+	}
+	return result;
+}
+
+size_t estimateValueSize(const std::map< string, string >& value)
+{
+	// a node of a red-black tree holds three pointers and the color besides the value
+	return value.size() * (4 * sizeof(void*) + sizeof(pair< const string, string >));
+}
+
+// lazy fields which are not parsed yet are charged by the length of their raw
+// value times 'rawFactor', as they take memory once parsed; the entries are
+// measured again on every use, so the values parsed meanwhile are charged by
+// their real size then
+template < typename T >
+size_t estimateLazyFieldSize(const cache::LazyField< T >& field, size_t rawFactor)
+{
+	const char* rawBegin;
+	const char* rawEnd;
+	if (field.getRaw(rawBegin, rawEnd))
+	{
+		return (rawEnd - rawBegin) * rawFactor;
+	}
+	return estimateValueSize(field.get());
+}
+
+size_t estimateSize(const vector< shared_ptr< cache::Version > >& versions)
+{
+	size_t result = versions.capacity() * sizeof(shared_ptr< cache::Version >);
+	FORIT(versionIt, versions)
+	{
+		const cache::Version* version = versionIt->get();
+		if (auto binaryVersion = dynamic_cast< const cache::BinaryVersion* >(version))
+		{
+			result += sizeof(cache::BinaryVersion) + binaryVersion->file.name.size();
+			for (size_t i = 0; i < cache::BinaryVersion::RelationTypes::Count; ++i)
+			{
+				result += estimateLazyFieldSize(binaryVersion->relations[i], 4);
+			}
+			result += estimateLazyFieldSize(binaryVersion->provides, 2);
+			result += estimateLazyFieldSize(binaryVersion->shortDescription, 1);
+			result += estimateLazyFieldSize(binaryVersion->longDescription, 1);
+			result += estimateLazyFieldSize(binaryVersion->tags, 1);
+		}
+		else
+		{
+			result += sizeof(cache::SourceVersion);
+		}
+		result += version->sources.capacity() * sizeof(cache::Version::Source) +
+				version->maintainer.size();
+		// the raw value is the whole record, and it is rarely parsed
+		result += estimateLazyFieldSize(version->others, 0);
+	}
+	return result;
+}
+
+}
+
+VersionLru::VersionLru(size_t budget)
+	: __budget(budget)
+{
+	memset(&__statistics, 0, sizeof(__statistics));
+}
+
+void VersionLru::__erase(std::list< Entry >::iterator it)
+{
+	__statistics.bytes -= it->size;
+	--__statistics.entryCount;
+	__positions.erase(it->package);
+	__entries.erase(it);
+}
+
+bool VersionLru::get(const cache::Package* package, vector< shared_ptr< cache::Version > >& versions)
+{
+	std::lock_guard< std::mutex > lock(__mutex);
+
+	auto positionIt = __positions.find(package);
+	if (positionIt == __positions.end())
+	{
+		++__statistics.missCount;
+		return false;
+	}
+	++__statistics.hitCount;
+	__entries.splice(__entries.begin(), __entries, positionIt->second);
+	Entry& entry = __entries.front();
+	versions = entry.versions;
+
+	// lazy fields parsed since the last use are charged now
+	auto size = estimateSize(entry.versions);
+	__statistics.bytes = __statistics.bytes - entry.size + size;
+	entry.size = size;
+	while (__statistics.bytes > __budget)
+	{
+		__erase(std::prev(__entries.end())); // the entry itself at last
+		++__statistics.evictionCount;
+	}
+	return true;
+}
+
+void VersionLru::put(const cache::Package* package, const vector< shared_ptr< cache::Version > >& versions)
+{
+	auto size = estimateSize(versions);
+	if (size > __budget)
+	{
+		return;
+	}
+
+	std::lock_guard< std::mutex > lock(__mutex);
+
+	auto positionIt = __positions.find(package);
+	if (positionIt != __positions.end())
+	{
+		__erase(positionIt->second);
+	}
+	while (__statistics.bytes + size > __budget)
+	{
+		__erase(std::prev(__entries.end()));
+		++__statistics.evictionCount;
+	}
+
+	__entries.push_front(Entry { package, versions, size });
+	__positions[package] = __entries.begin();
+	__statistics.bytes += size;
+	++__statistics.entryCount;
+}
+
+void VersionLru::erase(const cache::Package* package)
+{
+	std::lock_guard< std::mutex > lock(__mutex);
+
+	auto positionIt = __positions.find(package);
+	if (positionIt != __positions.end())
+	{
+		__erase(positionIt->second);
+	}
+}
+
+VersionLru::Statistics VersionLru::getStatistics() const
+{
+	std::lock_guard< std::mutex > lock(__mutex);
+	return __statistics;
+}
+
+}
+}
+}
+
@@ -0,0 +1,83 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#ifndef CUPT_INTERNAL_VERSIONLRU_SEEN
+#define CUPT_INTERNAL_VERSIONLRU_SEEN
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include <cupt/common.hpp>
+#include <cupt/fwd.hpp>
+
+namespace cupt {
+namespace internal {
+
+// parsed versions of recently used packages of a cache, kept while their
+// estimated size fits into the budget; the least recently used packages are
+// evicted first
+//
+// used when packages don't memoize their versions themselves (see
+// Package::memoize)
+namespace lru {
+
+class VersionLru
+{
+ public:
+	struct Statistics
+	{
+		size_t hitCount;
+		size_t missCount;
+		size_t evictionCount;
+		size_t entryCount;
+		size_t bytes; // estimated
+	};
+ private:
+	struct Entry
+	{
+		const cache::Package* package;
+		vector< shared_ptr< cache::Version > > versions;
+		size_t size;
+	};
+
+	mutable std::mutex __mutex;
+	const size_t __budget;
+	std::list< Entry > __entries; // the most recently used first
+	std::unordered_map< const cache::Package*, std::list< Entry >::iterator > __positions;
+	Statistics __statistics;
+
+	void __erase(std::list< Entry >::iterator);
+
+	VersionLru(const VersionLru&);
+	VersionLru& operator=(const VersionLru&);
+ public:
+	explicit VersionLru(size_t budget);
+	// returns false on a miss
+	bool get(const cache::Package*, vector< shared_ptr< cache::Version > >&);
+	void put(const cache::Package*, const vector< shared_ptr< cache::Version > >&);
+	void erase(const cache::Package*);
+	Statistics getStatistics() const;
+};
+
+}
+
+}
+}
+
+#endif
+
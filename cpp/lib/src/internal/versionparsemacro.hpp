@@ -58,17 +58,9 @@
 		})
 
 #define PARSE_OTHERS \
-			if (Version::parseOthers || (Version::parseInfoOnly && tagName.equal(BUFFER_AND_SIZE("Description-md5")))) \
+			if (!tagName.equal(BUFFER_AND_SIZE("Package")) && !tagName.equal(BUFFER_AND_SIZE("Status"))) \
 			{ \
-				if (!tagName.equal(BUFFER_AND_SIZE("Package")) && !tagName.equal(BUFFER_AND_SIZE("Status"))) \
-				{ \
-					if (!v->others) \
-					{ \
-						v->others = new map< string, string >; \
-					} \
-					string tagNameString(tagName); \
-					(*(v->others))[tagNameString] = tagValue; \
-				} \
+				v->others.get()[string(tagName)] = tagValue; \
 			}
 #endif
 
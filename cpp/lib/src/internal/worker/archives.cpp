@@ -94,13 +94,13 @@ vector< pair< string, shared_ptr< const BinaryVersion > > > ArchivesWorker::getA
 			continue;
 		}
 
-		auto versions = package->getVersions();
-		FORIT(versionIt, versions)
+		auto versions = package->getVersionRange();
+		for (auto versionIt = versions.begin(); versionIt != versions.end(); ++versionIt)
 		{
-			auto path = archivesDirectory + '/' + _get_archive_basename(*versionIt);
+			auto path = archivesDirectory + '/' + _get_archive_basename(**versionIt);
 			if (fs::fileExists(path))
 			{
-				knownArchives[path] = *versionIt;
+				knownArchives[path] = versionIt.getShared();
 
 				// checking for symlinks
 				auto readlinkResult = readlink(path.c_str(), &pathBuffer[0], pathMaxLength);
@@ -119,7 +119,7 @@ vector< pair< string, shared_ptr< const BinaryVersion > > > ArchivesWorker::getA
 					string targetPath(archivesDirectory + '/' + relativePath);
 					if (fs::fileExists(targetPath))
 					{
-						knownArchives[targetPath] = *versionIt;
+						knownArchives[targetPath] = versionIt.getShared();
 					}
 				}
 			}
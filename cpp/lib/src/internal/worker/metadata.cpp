@@ -31,6 +31,7 @@
 #include <internal/lock.hpp>
 #include <internal/tagparser.hpp>
 #include <internal/common.hpp>
+#include <internal/indexofindex.hpp>
 
 #include <internal/worker/metadata.hpp>
 
@@ -923,11 +924,32 @@ bool MetadataWorker::__update_release_and_index_data(download::Manager& download
 	{
 		return false;
 	}
+	__update_index_of_index(indexEntry);
 
 	__update_translations(downloadManager, indexEntry, indexFileChanged);
 	return true;
 }
 
+void MetadataWorker::__update_index_of_index(const cachefiles::IndexEntry& indexEntry)
+{
+	if (_config->getBool("cupt::worker::simulate") || !_config->getBool("cupt::cache::persistent-index"))
+	{
+		return;
+	}
+
+	auto indexPath = cachefiles::getPathOfIndexList(*_config, indexEntry);
+	_logger->log(Logger::Subsystem::Metadata, 3,
+			piddedFormat2("generating the index of index for '%s'", indexPath));
+	try
+	{
+		ioi::generate(indexPath, indexPath);
+	}
+	catch (...)
+	{
+		warn2(__("unable to generate the index of index for '%s'"), indexPath);
+	}
+}
+
 void MetadataWorker::__list_cleanup(const string& lockPath)
 {
 	_logger->log(Logger::Subsystem::Metadata, 2, "cleaning up old index lists");
@@ -985,7 +1007,7 @@ void MetadataWorker::updateReleaseAndIndexData(const shared_ptr< download::Progr
 	_logger->log(Logger::Subsystem::Metadata, 1, "updating package metadata");
 
 	auto indexesDirectory = __get_indexes_directory();
-	string lockFilePath = indexesDirectory + "/lock";
+	string lockFilePath = cachefiles::getPathOfListsLock(*_config);
 	shared_ptr< internal::Lock > lock;
 
 	try // preparations
@@ -46,6 +46,7 @@ class MetadataWorker: public virtual WorkerBase
 			const cachefiles::IndexEntry&, bool indexFileChanged);
 	bool __download_translations(download::Manager&, const cachefiles::IndexEntry& indexEntry,
 			const string&, const string&, const string&, bool, Logger* logger);
+	void __update_index_of_index(const cachefiles::IndexEntry&);
 	void __list_cleanup(const string&);
  public:
 	void updateReleaseAndIndexData(const shared_ptr< download::Progress >&);
@@ -150,7 +150,7 @@ set< string > __get_pseudo_essential_package_names(const Cache& cache, bool debu
 		{
 			if ((*versionIt)->essential)
 			{
-				FORIT(relationExpressionIt, (*versionIt)->relations[BinaryVersion::RelationTypes::PreDepends])
+				FORIT(relationExpressionIt, (*versionIt)->relations[BinaryVersion::RelationTypes::PreDepends].get())
 				{
 					processRelationExpression(*relationExpressionIt);
 				}
@@ -168,7 +168,7 @@ set< string > __get_pseudo_essential_package_names(const Cache& cache, bool debu
 					{ BinaryVersion::RelationTypes::PreDepends, BinaryVersion::RelationTypes::Depends };
 			for (size_t i = 0; i < sizeof(relationTypes)/sizeof(relationTypes[0]); ++i)
 			{
-				FORIT(relationExpressionIt, version->relations[relationTypes[i]])
+				FORIT(relationExpressionIt, version->relations[relationTypes[i]].get())
 				{
 					processRelationExpression(*relationExpressionIt);
 				}
@@ -344,7 +344,7 @@ void __fill_action_dependencies(FillActionGeneralInfo& gi,
 	InnerAction candidateAction;
 	candidateAction.type = actionType;
 
-	const RelationLine& relationLine = gi.innerActionPtr->version->relations[dependencyType];
+	const RelationLine& relationLine = gi.innerActionPtr->version->relations[dependencyType].get();
 	FORIT(relationExpressionIt, relationLine)
 	{
 		auto satisfyingVersions = gi.cache->getSatisfyingVersions(*relationExpressionIt);
@@ -374,7 +374,7 @@ void __fill_action_dependencies(FillActionGeneralInfo& gi,
 			{
 				// this is Conflicts, in the case there are appropriate
 				// Replaces, the 'remove before' action dependency should not be created
-				const RelationLine& replaces = masterAction.version->relations[BinaryVersion::RelationTypes::Replaces];
+				const RelationLine& replaces = masterAction.version->relations[BinaryVersion::RelationTypes::Replaces].get();
 				FORIT(replacesRelationExpressionIt, replaces)
 				{
 					auto replacesSatisfyingVersions = cache->getSatisfyingVersions(*replacesRelationExpressionIt);
@@ -489,8 +489,8 @@ const shared_ptr< const BinaryVersion > __create_virtual_version(
 	shared_ptr< BinaryVersion > virtualVersion(new BinaryVersion);
 	virtualVersion->packageName = version->packageName;
 	virtualVersion->versionString = version->versionString;
-	virtualVersion->relations[RT::PreDepends] = version->relations[RT::PreDepends];
-	virtualVersion->relations[RT::Depends] = version->relations[RT::Depends];
+	virtualVersion->relations[RT::PreDepends] = version->relations[RT::PreDepends].get();
+	virtualVersion->relations[RT::Depends] = version->relations[RT::Depends].get();
 	virtualVersion->essential = false;
 	return virtualVersion;
 }
@@ -1364,7 +1364,7 @@ map< string, pair< download::Manager::DownloadEntity, string > > PackagesWorker:
 				}
 
 				// paths
-				auto basename = _get_archive_basename(version);
+				auto basename = _get_archive_basename(*version);
 				auto downloadPath = archivesDirectory + partialDirectorySuffix + '/' + basename;
 				auto targetPath = archivesDirectory + '/' + basename;
 
@@ -1770,7 +1770,7 @@ string PackagesWorker::__generate_input_for_preinstall_v2_hooks(
 				break;
 				case InnerAction::Unpack:
 				{
-					path = archivesDirectory + "/" + _get_archive_basename(version);
+					path = archivesDirectory + "/" + _get_archive_basename(*version);
 				}
 			}
 			const string& packageName = version->packageName;
@@ -1857,7 +1857,7 @@ void PackagesWorker::__do_dpkg_pre_packages_actions(const vector< InnerActionGro
 				{
 					if (actionIt->type == InnerAction::Unpack)
 					{
-						auto debPath = archivesDirectory + "/" + _get_archive_basename(actionIt->version);
+						auto debPath = archivesDirectory + "/" + _get_archive_basename(*actionIt->version);
 						commandInput += debPath;
 						commandInput += "\n";
 					}
@@ -2197,7 +2197,7 @@ void PackagesWorker::changeSystem(const shared_ptr< download::Progress >& downlo
 					if (actionName == "unpack" || actionName == "install")
 					{
 						const shared_ptr< const BinaryVersion > version = actionIt->version;
-						actionExpression = archivesDirectory + '/' + _get_archive_basename(version);
+						actionExpression = archivesDirectory + '/' + _get_archive_basename(*version);
 					}
 					else
 					{
@@ -267,7 +267,7 @@ pair< size_t, size_t > SetupAndPreviewWorker::getDownloadSizesPreview() const
 			totalBytes += size;
 			needBytes += size; // for start
 
-			auto basename = _get_archive_basename(version);
+			auto basename = _get_archive_basename(*version);
 			auto path = archivesDirectory + "/" + basename;
 			if (fs::fileExists(path))
 			{
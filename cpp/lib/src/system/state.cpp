@@ -15,7 +15,10 @@
 *   Free Software Foundation, Inc.,                                       *
 *   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
 **************************************************************************/
+#include <cstdlib>
+#include <algorithm>
 #include <map>
+#include <unordered_map>
 
 #include <cupt/file.hpp>
 #include <cupt/system/state.hpp>
@@ -28,12 +31,16 @@
 #include <internal/tagparser.hpp>
 #include <internal/cacheimpl.hpp>
 #include <internal/common.hpp>
+#include <internal/statussnapshot.hpp>
+#include <internal/cachefiles.hpp>
+#include <internal/filesystem.hpp>
 
 namespace cupt {
 
 namespace internal {
 
 using std::map;
+using std::unordered_map;
 
 typedef system::State::InstalledRecord InstalledRecord;
 
@@ -47,7 +54,7 @@ struct StateData
 };
 
 void parseStatusSubstrings(const string& packageName, const string& input,
-		const shared_ptr< InstalledRecord >& installedRecord)
+		InstalledRecord& installedRecord)
 {
 	// status should be a triplet delimited by spaces (i.e. 2 ones)
 	internal::TagParser::StringRange current;
@@ -60,7 +67,7 @@ void parseStatusSubstrings(const string& packageName, const string& input,
 		++current.second;
 	}
 	{ // want
-#define CHECK_WANT(str, value) if (current.equal(BUFFER_AND_SIZE(str))) { installedRecord->want = InstalledRecord::Want:: value; } else
+#define CHECK_WANT(str, value) if (current.equal(BUFFER_AND_SIZE(str))) { installedRecord.want = InstalledRecord::Want:: value; } else
 		CHECK_WANT("install", Install)
 		CHECK_WANT("deinstall", Deinstall)
 		CHECK_WANT("unknown", Unknown)
@@ -82,7 +89,7 @@ void parseStatusSubstrings(const string& packageName, const string& input,
 		++current.second;
 	}
 	{ // flag
-#define CHECK_FLAG(str, value) if (current.equal(BUFFER_AND_SIZE(str))) { installedRecord->flag = InstalledRecord::Flag:: value; } else
+#define CHECK_FLAG(str, value) if (current.equal(BUFFER_AND_SIZE(str))) { installedRecord.flag = InstalledRecord::Flag:: value; } else
 		CHECK_FLAG("ok", Ok)
 		CHECK_FLAG("reinstreq", Reinstreq)
 		CHECK_FLAG("hold", Hold)
@@ -100,7 +107,7 @@ void parseStatusSubstrings(const string& packageName, const string& input,
 	current.first = current.second + 1;
 	current.second = end;
 	{ // status
-#define CHECK_STATUS(str, value) if (current.equal(BUFFER_AND_SIZE(str))) { installedRecord->status = InstalledRecord::Status:: value; } else
+#define CHECK_STATUS(str, value) if (current.equal(BUFFER_AND_SIZE(str))) { installedRecord.status = InstalledRecord::Status:: value; } else
 		CHECK_STATUS("installed", Installed)
 		CHECK_STATUS("not-installed", NotInstalled)
 		CHECK_STATUS("config-files", ConfigFiles)
@@ -135,49 +142,78 @@ VersionSource* createVersionSource(internal::CacheImpl* cacheImpl,
 	releaseInfo->vendor = "dpkg";
 	releaseInfo->verified = false;
 	releaseInfo->notAutomatic = false;
+	releaseInfo->butAutomaticUpgrades = false;
+	auto release = cacheImpl->registerRelease(releaseInfo);
 
-	cacheImpl->binaryReleaseData.push_back(releaseInfo);
+	// installed releases go before archive ones even if the archive metadata
+	// was read first
+	auto& releaseData = cacheImpl->binaryReleaseData;
+	releaseData.insert(std::find_if(releaseData.begin(), releaseData.end(),
+			[](const shared_ptr< const ReleaseInfo >& release) { return !release->baseUri.empty(); }),
+			release);
 
-	cacheImpl->releaseInfoAndFileStorage.push_back(make_pair(releaseInfo, file));
+	cacheImpl->releaseInfoAndFileStorage.push_back(make_pair(release, file));
 	return &*(cacheImpl->releaseInfoAndFileStorage.rbegin());
 }
 
-void StateData::parseDpkgStatus()
+// journal entries of dpkg, written before they are merged into the status file
+vector< string > getDpkgJournalPaths(const string& statusPath)
 {
-	string path = config->getPath("dir::state::status");
-	string openError;
-	shared_ptr< File > file(new File(path, "r", openError));
-	if (!openError.empty())
+	vector< string > result;
+	auto journalDirectory = fs::dirname(statusPath) + "/updates";
+	if (!fs::dirExists(journalDirectory))
 	{
-		fatal2(__("unable to open the dpkg status file '%s': %s"), path, openError);
+		return result;
 	}
 
-	/*
-	 Status lines are similar to apt Packages ones, with two differences:
-	 1) 'Status' field: see header for possible values
-	 2) purged packages contain only 'Package', 'Status', 'Priority'
-	    and 'Section' fields.
-	*/
-
-	auto installedSource = createVersionSource(cacheImpl, "installed", file);
-	auto improperlyInstalledSource = createVersionSource(cacheImpl, "improperly-installed", file);
+	vector< pair< size_t, string > > numberedPaths;
+	auto paths = fs::lglob(journalDirectory, "*");
+	FORIT(pathIt, paths)
+	{
+		auto name = fs::filename(*pathIt);
+		if (!name.empty() && name.find_first_not_of("0123456789") == string::npos)
+		{
+			numberedPaths.push_back({ strtoul(name.c_str(), NULL, 10), *pathIt });
+		}
+	}
+	std::sort(numberedPaths.begin(), numberedPaths.end());
 
-	auto preBinaryPackages = &(cacheImpl->preBinaryPackages);
+	FORIT(it, numberedPaths)
+	{
+		result.push_back(it->second);
+	}
+	return result;
+}
 
-	internal::CacheImpl::PrePackageRecord prePackageRecord;
+shared_ptr< File > openStatusFile(const string& path)
+{
+	string openError;
+	shared_ptr< File > file(new File(path, "m", openError));
+	if (!openError.empty())
+	{
+		fatal2(__("unable to open the dpkg status file '%s': %s"), path, openError);
+	}
+	return file;
+}
 
+/*
+ Status lines are similar to apt Packages ones, with two differences:
+ 1) 'Status' field: see header for possible values
+ 2) purged packages contain only 'Package', 'Status', 'Priority'
+    and 'Section' fields.
+*/
+void scanStatusFile(File* file, const string& path, vector< dss::Record >& records)
+{
 	try
 	{
-		internal::TagParser parser(file.get());
+		internal::TagParser parser(file);
 		internal::TagParser::StringRange tagName, tagValue;
 
-		pair< const string, vector< internal::CacheImpl::PrePackageRecord > > pairForInsertion;
-		string& packageName = const_cast< string& >(pairForInsertion.first);
-
-		while ((prePackageRecord.offset = file->tell()), (parser.parseNextLine(tagName, tagValue) && !file->eof()))
+		dss::Record record;
+		while ((record.offset = file->tell()), (parser.parseNextLine(tagName, tagValue) && !file->eof()))
 		{
 			string status;
-			string provides;
+			record.provides.clear();
 			bool parsedTagsByIndex[4] = {0};
 			bool& packageNameIsPresent = parsedTagsByIndex[0];
 			bool& versionIsPresent = parsedTagsByIndex[2];
@@ -191,52 +227,158 @@ void StateData::parseDpkgStatus()
 					continue; \
 				} \
 
-				TAG("Package", 0, packageName = tagValue)
+				TAG("Package", 0, record.packageName = tagValue)
 				TAG("Status", 1, status = tagValue)
 				TAG("Version", 2, ;)
-				TAG("Provides", 3, provides = tagValue)
+				TAG("Provides", 3, record.provides = tagValue)
 #undef TAG
 			} while (parser.parseNextLine(tagName, tagValue));
 
-			if (!versionIsPresent)
-			{
-				continue;
-			}
 			// we don't check package name for correctness - even if it's incorrent, we can't decline installed packages :(
 
 			if (!packageNameIsPresent)
 			{
+				if (!versionIsPresent)
+				{
+					continue;
+				}
 				fatal2(__("no package name in the record"));
 			}
-			auto installedRecord = std::make_shared< InstalledRecord >();
-			parseStatusSubstrings(packageName, status, installedRecord);
-
-			if (packageHasFullEntryInfo(*installedRecord))
+			record.hasVersion = versionIsPresent;
+			if (record.hasVersion)
 			{
-				// this conditions mean that package is installed or
-				// semi-installed, regardless it has full entry info, so add it
-				// (info) to cache
-				prePackageRecord.releaseInfoAndFile = installedRecord->isBroken() ?
-						improperlyInstalledSource : installedSource;
+				InstalledRecord installedRecord;
+				parseStatusSubstrings(record.packageName, status, installedRecord);
+				record.want = installedRecord.want;
+				record.flag = installedRecord.flag;
+				record.status = installedRecord.status;
+			}
+			records.push_back(record);
+		}
+	}
+	catch (Exception&)
+	{
+		fatal2(__("error parsing the dpkg status file '%s'"), path);
+	}
+}
 
-				auto it = preBinaryPackages->insert(pairForInsertion).first;
-				it->second.push_back(prePackageRecord);
+void StateData::parseDpkgStatus()
+{
+	string path = config->getPath("dir::state::status");
 
-				if (!provides.empty())
-				{
-					cacheImpl->processProvides(&it->first,
-							&*(provides.begin()), &*(provides.end()));
-				}
+	// the file may be replaced by dpkg at any time, the snapshot is only
+	// trusted if the opened file is the one the signature was taken from
+	pf::Signature signature;
+	bool signatureIsValid = pf::getSignature(path, signature);
+	auto file = openStatusFile(path);
+	pf::Signature signatureAfterOpening;
+	signatureIsValid = signatureIsValid && pf::getSignature(path, signatureAfterOpening) &&
+			signature == signatureAfterOpening;
+
+	vector< dss::Record > records;
+	bool useSnapshot = config->getBool("cupt::cache::persistent-index") && signatureIsValid;
+	auto snapshotPath = cachefiles::getPathOfDpkgStatusSnapshot(*config);
+	if (!useSnapshot || !dss::read(snapshotPath, signature, records))
+	{
+		scanStatusFile(file.get(), path, records);
+		if (useSnapshot)
+		{
+			pf::WriteLock writeLock(*config, cachefiles::getPathOfListsLock(*config));
+			if (writeLock.isAcquired())
+			{
+				dss::write(snapshotPath, signature, records);
 			}
+		}
+	}
+
+	auto installedSource = createVersionSource(cacheImpl, "installed", file);
+	auto improperlyInstalledSource = createVersionSource(cacheImpl, "improperly-installed", file);
+
+	// records of the journal replace records of the same packages in the status file
+	struct Entry
+	{
+		const dss::Record* record;
+		VersionSource* installedSource;
+		VersionSource* improperlyInstalledSource;
+	};
+	vector< Entry > entries;
+	unordered_map< string, size_t > entryIndexes;
+	FORIT(recordIt, records)
+	{
+		entryIndexes[recordIt->packageName] = entries.size();
+		entries.push_back({ &*recordIt, installedSource, improperlyInstalledSource });
+	}
+
+	auto journalPaths = getDpkgJournalPaths(path);
+	vector< vector< dss::Record > > journalRecords(journalPaths.size());
+	for (size_t i = 0; i < journalPaths.size(); ++i)
+	{
+		auto journalFile = openStatusFile(journalPaths[i]);
+		scanStatusFile(journalFile.get(), journalPaths[i], journalRecords[i]);
+
+		auto& storage = cacheImpl->releaseInfoAndFileStorage;
+		storage.push_back(make_pair(installedSource->first, journalFile));
+		auto journalInstalledSource = &storage.back();
+		storage.push_back(make_pair(improperlyInstalledSource->first, journalFile));
+		auto journalImproperlyInstalledSource = &storage.back();
 
-			// add parsed info to installed_info
-			installedInfo.insert(pair< const string, shared_ptr< const InstalledRecord > >(
-					std::move(packageName), std::move(installedRecord)));
+		FORIT(recordIt, journalRecords[i])
+		{
+			Entry entry = { &*recordIt, journalInstalledSource, journalImproperlyInstalledSource };
+			auto insertResult = entryIndexes.insert({ recordIt->packageName, entries.size() });
+			if (insertResult.second)
+			{
+				entries.push_back(entry);
+			}
+			else
+			{
+				entries[insertResult.first->second] = entry;
+			}
 		}
 	}
-	catch (Exception&)
+
+	auto preBinaryPackages = &(cacheImpl->preBinaryPackages);
+	pair< const string, vector< internal::CacheImpl::PrePackageRecord > > pairForInsertion;
+	string& packageName = const_cast< string& >(pairForInsertion.first);
+	internal::CacheImpl::PrePackageRecord prePackageRecord;
+
+	FORIT(entryIt, entries)
 	{
-		fatal2(__("error parsing the dpkg status file '%s'"), path);
+		const dss::Record& record = *entryIt->record;
+		if (!record.hasVersion)
+		{
+			continue;
+		}
+		packageName = record.packageName;
+
+		auto installedRecord = std::make_shared< InstalledRecord >();
+		installedRecord->want = record.want;
+		installedRecord->flag = record.flag;
+		installedRecord->status = record.status;
+
+		if (packageHasFullEntryInfo(*installedRecord))
+		{
+			// this conditions mean that package is installed or
+			// semi-installed, regardless it has full entry info, so add it
+			// (info) to cache
+			prePackageRecord.offset = record.offset;
+			prePackageRecord.releaseInfoAndFile = installedRecord->isBroken() ?
+					entryIt->improperlyInstalledSource : entryIt->installedSource;
+
+			auto it = preBinaryPackages->insert(pairForInsertion).first;
+			// the installed version has to be the first one
+			it->second.insert(it->second.begin(), prePackageRecord);
+
+			if (!record.provides.empty())
+			{
+				cacheImpl->processProvides(&it->first,
+						record.provides.data(), record.provides.data() + record.provides.size(), true);
+			}
+		}
+
+		// add parsed info to installed_info
+		installedInfo.insert(pair< const string, shared_ptr< const InstalledRecord > >(
+				std::move(packageName), std::move(installedRecord)));
 	}
 }
 
@@ -0,0 +1,121 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+
+// the min-max heap against a sorted multiset, with random operations
+
+#include <cstdlib>
+#include <functional>
+#include <iterator>
+#include <set>
+
+#include <internal/nativeresolver/minmaxheap.hpp>
+
+#include "check.hpp"
+
+using namespace cupt;
+using internal::MinMaxHeap;
+
+namespace {
+
+// keeps runs reproducible
+uint32_t getRandom(uint32_t limit)
+{
+	static uint32_t state = 12345;
+	state = state * 1103515245 + 12345;
+	return (state >> 16) % limit;
+}
+
+void checkGreatest(const MinMaxHeap< int, std::less< int > >& heap, const std::multiset< int >& expected)
+{
+	size_t count = getRandom(12);
+	auto greatest = heap.getGreatest(count);
+	CHECK(greatest.size() == std::min(count, expected.size()));
+	auto expectedIt = expected.rbegin();
+	for (auto it = greatest.begin(); it != greatest.end() && expectedIt != expected.rend(); ++it)
+	{
+		CHECK(**it == *expectedIt);
+		++expectedIt;
+	}
+}
+
+}
+
+int main()
+{
+	MinMaxHeap< int, std::less< int > > heap;
+	std::multiset< int > expected;
+
+	CHECK(heap.empty());
+	CHECK(heap.getGreatest(3).empty());
+
+	for (size_t i = 0; i < 20000; ++i)
+	{
+		// grows on average, then shrinks down to empty
+		uint32_t operation = getRandom(i < 10000 ? 5 : 3);
+		if (operation >= 2 || expected.empty())
+		{
+			int value = getRandom(1000); // with duplicates
+			heap.push(value);
+			expected.insert(value);
+		}
+		else if (operation == 0)
+		{
+			CHECK(heap.extractLeast() == *expected.begin());
+			expected.erase(expected.begin());
+		}
+		else
+		{
+			CHECK(heap.extractGreatest() == *expected.rbegin());
+			expected.erase(std::prev(expected.end()));
+		}
+
+		CHECK(heap.size() == expected.size());
+		if (!expected.empty())
+		{
+			CHECK(heap.getLeast() == *expected.begin());
+			CHECK(heap.getGreatest() == *expected.rbegin());
+		}
+		if (i % 16 == 0)
+		{
+			checkGreatest(heap, expected);
+		}
+	}
+
+	while (!expected.empty())
+	{
+		CHECK(heap.extractGreatest() == *expected.rbegin());
+		expected.erase(std::prev(expected.end()));
+	}
+	CHECK(heap.empty());
+
+	// a custom order: the greatest by the first member only
+	typedef std::pair< int, int > Pair;
+	auto lessByFirst = [](const Pair& left, const Pair& right) { return left.first < right.first; };
+	MinMaxHeap< Pair, std::function< bool (const Pair&, const Pair&) > > pairHeap(lessByFirst);
+	for (int i = 0; i < 100; ++i)
+	{
+		pairHeap.push(Pair((i * 37) % 100, i));
+	}
+	for (int i = 99; i >= 0; --i)
+	{
+		CHECK(pairHeap.extractGreatest().first == i);
+	}
+
+	return test::failureCount ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
@@ -0,0 +1,346 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+
+// round trips of the persistent files (index of index, translation index,
+// dpkg status snapshot) and their rejection once the source file is changed
+// or the persistent file is damaged
+
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <list>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include <internal/indexofindex.hpp>
+#include <internal/persistentfile.hpp>
+#include <internal/statussnapshot.hpp>
+#include <internal/translationindex.hpp>
+
+#include "check.hpp"
+
+using namespace cupt;
+using namespace cupt::internal;
+
+namespace {
+
+string directory;
+
+string getPath(const char* name)
+{
+	return directory + '/' + name;
+}
+
+void writeFile(const string& path, const string& contents)
+{
+	FILE* file = fopen(path.c_str(), "w");
+	if (!file || fwrite(contents.data(), 1, contents.size(), file) != contents.size() || fclose(file))
+	{
+		fatal2("unable to write the file '%s'", path);
+	}
+}
+
+string readFile(const string& path)
+{
+	string result;
+	FILE* file = fopen(path.c_str(), "r");
+	if (!file)
+	{
+		fatal2("unable to open the file '%s'", path);
+	}
+	char buffer[4096];
+	size_t size;
+	while ((size = fread(buffer, 1, sizeof(buffer), file)))
+	{
+		result.append(buffer, size);
+	}
+	fclose(file);
+	return result;
+}
+
+// replaces the contents of the file by the contents of the same size, keeping
+// the signature, so only the persistent file knows of the old contents
+void overwriteKeepingSignature(const string& path, const string& contents)
+{
+	struct stat before;
+	CHECK(stat(path.c_str(), &before) == 0 && (size_t)before.st_size == contents.size());
+	int fd = open(path.c_str(), O_WRONLY);
+	CHECK(fd != -1 && write(fd, contents.data(), contents.size()) == (ssize_t)contents.size());
+	close(fd);
+	struct timespec times[2] = { before.st_atim, before.st_mtim };
+	CHECK(utimensat(AT_FDCWD, path.c_str(), times, 0) == 0);
+}
+
+void changeModificationTime(const string& path)
+{
+	struct stat before;
+	CHECK(stat(path.c_str(), &before) == 0);
+	struct timespec times[2] = { before.st_atim, before.st_mtim };
+	times[1].tv_sec += 1;
+	CHECK(utimensat(AT_FDCWD, path.c_str(), times, 0) == 0);
+}
+
+// damaged variants of a valid persistent file
+vector< string > getDamagedVariants(const string& contents)
+{
+	vector< string > result;
+	result.push_back(string());
+	result.push_back(contents.substr(0, 8)); // a part of the header
+	result.push_back(contents.substr(0, contents.size() - 1));
+	result.push_back(contents + '\0');
+
+	string wrongMagic = contents;
+	wrongMagic[0] ^= 1;
+	result.push_back(wrongMagic);
+
+	string wrongFormatVersion = contents;
+	wrongFormatVersion[8] ^= 1;
+	result.push_back(wrongFormatVersion);
+
+	string wrongByteOrder = contents;
+	std::reverse(wrongByteOrder.begin() + 12, wrongByteOrder.begin() + 16);
+	result.push_back(wrongByteOrder);
+
+	return result;
+}
+
+// "<package name>@<offset>[ provides <provides>]" for every record
+vector< string > readIndex(const string& indexPath, bool usePersistentIndex)
+{
+	vector< string > result;
+	std::list< string > packageNames;
+
+	ioi::Callbacks callbacks;
+	callbacks.main = [&result, &packageNames](const string& packageName, size_t offset)
+	{
+		result.push_back(format2("%s@%zu", packageName, offset));
+		packageNames.push_back(packageName);
+		return &packageNames.back();
+	};
+	callbacks.provides = [&result](const string*, const char* begin, const char* end)
+	{
+		result.back() += " provides " + string(begin, end);
+	};
+	ioi::processIndex(indexPath, callbacks, "test", usePersistentIndex, false);
+
+	return result;
+}
+
+void testIndexOfIndex()
+{
+	const string indexPath = getPath("Packages");
+	const string ioiPath = ioi::getIndexOfIndexPath(indexPath);
+
+	writeFile(indexPath, "Package: aaa\nProvides: x, y\n\nPackage: bbb\nVersion: 1\n\n");
+	auto firstRecords = readIndex(indexPath, false);
+	CHECK(firstRecords.size() == 2);
+	CHECK(firstRecords[0] == "aaa@13 provides x, y");
+
+	// no index of index yet
+	CHECK(readIndex(indexPath, true) == firstRecords);
+
+	ioi::generate(indexPath, "test");
+	CHECK(readIndex(indexPath, true) == firstRecords);
+
+	overwriteKeepingSignature(indexPath, "Package: ccc\nProvides: zzz\n\nPackage: dddd\nVersion: 1\n\n");
+	auto secondRecords = readIndex(indexPath, false);
+	CHECK(secondRecords.size() == 2);
+	CHECK(secondRecords != firstRecords);
+	// the index of index is used while the signature matches
+	CHECK(readIndex(indexPath, true) == firstRecords);
+
+	const string validContents = readFile(ioiPath);
+	auto damagedVariants = getDamagedVariants(validContents);
+	FORIT(it, damagedVariants)
+	{
+		writeFile(ioiPath, *it);
+		CHECK(readIndex(indexPath, true) == secondRecords);
+	}
+
+	writeFile(ioiPath, validContents);
+	CHECK(readIndex(indexPath, true) == firstRecords);
+	changeModificationTime(indexPath);
+	CHECK(readIndex(indexPath, true) == secondRecords);
+
+	// regenerated for the new signature
+	ioi::generate(indexPath, "test");
+	CHECK(readFile(ioiPath) != validContents);
+	CHECK(readIndex(indexPath, true) == secondRecords);
+
+	unlink(ioiPath.c_str());
+	unlink(indexPath.c_str());
+}
+
+const char firstDigest[] = "0123456789abcdef0123456789abcdef";
+const char secondDigest[] = "fedcba9876543210FEDCBA9876543210";
+const char unknownDigest[] = "00000000000000000000000000000000";
+
+tri::Digest getDigest(const char* hex)
+{
+	tri::Digest result;
+	CHECK(tri::parseDigest(hex, hex + strlen(hex), result));
+	return result;
+}
+
+string makeTranslation(const char* digest1, const char* digest2)
+{
+	return format2("Package: aaa\nDescription-md5: %s\nDescription-en: first\n long\n\n"
+			"Package: bbb\nDescription-md5: %s\nDescription-en: second\n\n"
+			"Package: ccc\nDescription-md5: %s\nDescription-en: duplicate\n\n",
+			digest1, digest2, digest1);
+}
+
+// offsets of translations of the first, second and unknown digests
+vector< ssize_t > readTranslationIndex(const string& translationPath, bool usePersistentIndex)
+{
+	tri::Index index(translationPath, "test", usePersistentIndex, false);
+	vector< ssize_t > result;
+	result.push_back(index.find(getDigest(firstDigest)));
+	result.push_back(index.find(getDigest(secondDigest)));
+	result.push_back(index.find(getDigest(unknownDigest)));
+	return result;
+}
+
+void testTranslationIndex()
+{
+	tri::Digest digest;
+	CHECK(!tri::parseDigest(firstDigest, firstDigest + 31, digest));
+	const char nonHex[] = "0123456789abcdef0123456789abcdeg";
+	CHECK(!tri::parseDigest(nonHex, nonHex + 32, digest));
+	digest = getDigest(secondDigest);
+	CHECK(digest.bytes[0] == 0xfe && digest.bytes[15] == 0x10);
+
+	const string translationPath = getPath("Translation-en");
+	const string triPath = tri::getTranslationIndexPath(translationPath);
+
+	const string firstContents = makeTranslation(firstDigest, secondDigest);
+	writeFile(translationPath, firstContents);
+	auto firstOffsets = readTranslationIndex(translationPath, false);
+	CHECK(firstOffsets[0] == (ssize_t)firstContents.find("first"));
+	CHECK(firstOffsets[1] == (ssize_t)firstContents.find("second"));
+	CHECK(firstOffsets[2] == -1);
+
+	{ // writes the translation index
+		tri::Index index(translationPath, "test", true, true);
+	}
+	CHECK(readTranslationIndex(translationPath, true) == firstOffsets);
+
+	overwriteKeepingSignature(translationPath, makeTranslation(secondDigest, firstDigest));
+	auto secondOffsets = readTranslationIndex(translationPath, false);
+	CHECK(secondOffsets[0] == firstOffsets[1] && secondOffsets[1] == firstOffsets[0]);
+	CHECK(readTranslationIndex(translationPath, true) == firstOffsets);
+
+	const string validContents = readFile(triPath);
+	auto damagedVariants = getDamagedVariants(validContents);
+	FORIT(it, damagedVariants)
+	{
+		writeFile(triPath, *it);
+		CHECK(readTranslationIndex(translationPath, true) == secondOffsets);
+	}
+
+	writeFile(triPath, validContents);
+	changeModificationTime(translationPath);
+	CHECK(readTranslationIndex(translationPath, true) == secondOffsets);
+
+	unlink(triPath.c_str());
+	unlink(translationPath.c_str());
+}
+
+bool areRecordsEqual(const dss::Record& left, const dss::Record& right)
+{
+	return left.packageName == right.packageName && left.hasVersion == right.hasVersion &&
+			(!left.hasVersion || (left.want == right.want && left.flag == right.flag &&
+			left.status == right.status && left.offset == right.offset &&
+			left.provides == right.provides));
+}
+
+void testStatusSnapshot()
+{
+	typedef dss::Record::InstalledRecord InstalledRecord;
+
+	const string statusPath = getPath("status");
+	const string snapshotPath = getPath("status.dss");
+	writeFile(statusPath, "Package: aaa\n\n");
+	pf::Signature statusSignature;
+	CHECK(pf::getSignature(statusPath, statusSignature));
+
+	vector< dss::Record > records(2);
+	records[0].packageName = "aaa";
+	records[0].hasVersion = true;
+	records[0].want = InstalledRecord::Want::Hold;
+	records[0].flag = InstalledRecord::Flag::Reinstreq;
+	records[0].status = InstalledRecord::Status::HalfConfigured;
+	records[0].offset = 1234567890123ull;
+	records[0].provides = "x, y (= 1)";
+	records[1].packageName = "bbb";
+	records[1].hasVersion = false;
+
+	vector< dss::Record > readRecords;
+	CHECK(!dss::read(snapshotPath, statusSignature, readRecords));
+
+	dss::write(snapshotPath, statusSignature, records);
+	CHECK(dss::read(snapshotPath, statusSignature, readRecords));
+	CHECK(readRecords.size() == records.size());
+	CHECK(std::equal(records.begin(), records.end(), readRecords.begin(), areRecordsEqual));
+
+	pf::Signature otherSignature = statusSignature;
+	otherSignature.modificationTimeNsec ^= 1;
+	CHECK(!dss::read(snapshotPath, otherSignature, readRecords));
+
+	const string validContents = readFile(snapshotPath);
+	auto damagedVariants = getDamagedVariants(validContents);
+	FORIT(it, damagedVariants)
+	{
+		writeFile(snapshotPath, *it);
+		CHECK(!dss::read(snapshotPath, statusSignature, readRecords));
+	}
+
+	unlink(snapshotPath.c_str());
+	unlink(statusPath.c_str());
+}
+
+}
+
+int main()
+{
+	char directoryTemplate[] = "/tmp/cupt-test-XXXXXX";
+	if (!mkdtemp(directoryTemplate))
+	{
+		perror("mkdtemp");
+		return 1;
+	}
+	directory = directoryTemplate;
+
+	try
+	{
+		testIndexOfIndex();
+		testTranslationIndex();
+		testStatusSnapshot();
+	}
+	catch (Exception& e)
+	{
+		fprintf(stderr, "unexpected exception: %s\n", e.what());
+		++test::failureCount;
+	}
+
+	rmdir(directory.c_str());
+	return test::failureCount ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
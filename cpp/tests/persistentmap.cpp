@@ -0,0 +1,258 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+
+// the persistent map (a hash array mapped trie) against std::map: random
+// changes, copies which are not affected by changes of each other, the shape
+// independent of the insertion order and no leaked values
+
+#include <cstdlib>
+#include <algorithm>
+#include <map>
+#include <thread>
+
+#include <internal/nativeresolver/persistentmap.hpp>
+
+#include "check.hpp"
+
+using namespace cupt;
+using internal::PersistentMap;
+
+namespace {
+
+std::atomic< int > aliveValueCount(0);
+
+struct Value
+{
+	int value;
+
+	explicit Value(int value_)
+		: value(value_)
+	{
+		++aliveValueCount;
+	}
+	Value(const Value& other)
+		: value(other.value)
+	{
+		++aliveValueCount;
+	}
+	~Value()
+	{
+		--aliveValueCount;
+	}
+};
+
+typedef PersistentMap< Value > Map;
+typedef std::map< uint32_t, int > ExpectedMap;
+
+// keeps runs reproducible
+uint32_t getRandom(uint32_t limit)
+{
+	static uint32_t state = 12345;
+	state = state * 1103515245 + 12345;
+	return (state >> 16) % limit;
+}
+
+// dense keys mostly, and some which share many low bits with others
+uint32_t getRandomKey()
+{
+	uint32_t key = getRandom(2000);
+	if (!getRandom(8))
+	{
+		key |= getRandom(4) << 30;
+	}
+	return key;
+}
+
+vector< std::pair< uint32_t, int > > getElements(const Map& map)
+{
+	vector< std::pair< uint32_t, int > > result;
+	map.forEach([&result](uint32_t key, const Value& value)
+	{
+		result.push_back(std::make_pair(key, value.value));
+	});
+	return result;
+}
+
+bool isEqual(const Map& map, const ExpectedMap& expected)
+{
+	if (map.size() != expected.size())
+	{
+		return false;
+	}
+	FORIT(it, expected)
+	{
+		auto value = map.find(it->first);
+		if (!value || value->value != it->second)
+		{
+			return false;
+		}
+	}
+	auto elements = getElements(map);
+	std::sort(elements.begin(), elements.end());
+	return elements == vector< std::pair< uint32_t, int > >(expected.begin(), expected.end());
+}
+
+void changeRandomly(Map& map, ExpectedMap& expected, size_t changeCount)
+{
+	for (size_t i = 0; i < changeCount; ++i)
+	{
+		uint32_t key = getRandomKey();
+		if (getRandom(3))
+		{
+			int value = getRandom(1000000);
+			map.set(key, value);
+			expected[key] = value;
+		}
+		else
+		{
+			CHECK(map.erase(key) == (expected.erase(key) != 0));
+		}
+	}
+}
+
+void testRandomChanges()
+{
+	Map map;
+	ExpectedMap expected;
+	CHECK(!map.find(0));
+	CHECK(!map.erase(0));
+
+	// snapshots are copies taken along the way, they must not change
+	vector< std::pair< Map, ExpectedMap > > snapshots;
+	for (size_t i = 0; i < 40; ++i)
+	{
+		changeRandomly(map, expected, 500);
+		CHECK(isEqual(map, expected));
+		snapshots.push_back(std::make_pair(map, expected));
+	}
+	FORIT(it, snapshots)
+	{
+		CHECK(isEqual(it->first, it->second));
+	}
+
+	// changing a snapshot leaves the others intact
+	changeRandomly(snapshots[10].first, snapshots[10].second, 500);
+	FORIT(it, snapshots)
+	{
+		CHECK(isEqual(it->first, it->second));
+	}
+
+	const ExpectedMap lastExpected = expected;
+	FORIT(it, lastExpected)
+	{
+		CHECK(map.erase(it->first));
+	}
+	CHECK(map.size() == 0 && getElements(map).empty());
+	CHECK(isEqual(snapshots.back().first, snapshots.back().second));
+}
+
+void testShape()
+{
+	vector< uint32_t > keys;
+	for (uint32_t i = 0; i < 3000; ++i)
+	{
+		keys.push_back(i * 7 + (i % 3 ? 0 : (1u << 31)));
+	}
+
+	Map forward;
+	FORIT(it, keys)
+	{
+		forward.set(*it, *it);
+	}
+	Map backward;
+	for (auto it = keys.rbegin(); it != keys.rend(); ++it)
+	{
+		backward.set(*it, 0);
+		backward.set(*it, *it); // replaced
+	}
+	// extra keys added and removed
+	for (uint32_t key = 1; key < 3000; key += 7)
+	{
+		backward.set(key, 0);
+	}
+	for (uint32_t key = 1; key < 3000; key += 7)
+	{
+		backward.erase(key);
+	}
+	CHECK(backward.size() == keys.size());
+	CHECK(getElements(forward) == getElements(backward));
+}
+
+void testThreads()
+{
+	Map base;
+	ExpectedMap expectedBase;
+	changeRandomly(base, expectedBase, 2000);
+
+	const size_t threadCount = 4;
+	vector< Map > copies(threadCount, base);
+	vector< std::thread > threads;
+	for (size_t i = 0; i < threadCount; ++i)
+	{
+		threads.push_back(std::thread([&copies, i]()
+		{
+			Map& copy = copies[i];
+			for (uint32_t key = 0; key < 2000; ++key)
+			{
+				if (key % threadCount == i)
+				{
+					copy.erase(key);
+				}
+				else
+				{
+					copy.set(key, int(key + i));
+				}
+			}
+		}));
+	}
+	FORIT(it, threads)
+	{
+		it->join();
+	}
+
+	CHECK(isEqual(base, expectedBase));
+	for (size_t i = 0; i < threadCount; ++i)
+	{
+		ExpectedMap expectedCopy = expectedBase;
+		for (uint32_t key = 0; key < 2000; ++key)
+		{
+			if (key % threadCount == i)
+			{
+				expectedCopy.erase(key);
+			}
+			else
+			{
+				expectedCopy[key] = key + i;
+			}
+		}
+		CHECK(isEqual(copies[i], expectedCopy));
+	}
+}
+
+}
+
+int main()
+{
+	testRandomChanges();
+	testShape();
+	testThreads();
+	CHECK(aliveValueCount == 0);
+
+	return test::failureCount ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
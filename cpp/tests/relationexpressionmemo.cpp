@@ -0,0 +1,87 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+
+// the relation expression memo finds entries by the contents of expressions,
+// whatever the lookup hint left in the expression says
+
+#include <cstdlib>
+
+#include <internal/relationexpressionmemo.hpp>
+
+#include "check.hpp"
+
+using namespace cupt;
+using namespace cupt::cache;
+using internal::RelationExpressionMemo;
+
+int main()
+{
+	RelationExpressionMemo memo;
+	RelationExpression first(string("aaa (>= 1.0) | bbb"));
+	RelationExpression firstCopy(string("aaa (>= 1.0) | bbb"));
+	RelationExpression second(string("aaa (>= 1.1) | bbb"));
+
+	CHECK(!memo.find(first));
+	memo.add(first, RelationExpressionMemo::Value(1));
+	CHECK(memo.find(first) && memo.find(first)->size() == 1);
+	CHECK(memo.find(firstCopy) && memo.find(firstCopy)->size() == 1);
+	CHECK(!memo.find(second));
+
+	memo.add(second, RelationExpressionMemo::Value(2));
+	CHECK(memo.size() == 2);
+	CHECK(memo.find(second) && memo.find(second)->size() == 2);
+	CHECK(memo.find(first) && memo.find(first)->size() == 1);
+
+	// the hint of a changed expression points to the old entry
+	first[0].versionString = "1.1";
+	CHECK(memo.find(first) && memo.find(first)->size() == 2);
+
+	// a copy carries the hint as well
+	RelationExpression changedCopy = firstCopy;
+	changedCopy[0].packageName = "ccc";
+	CHECK(!memo.find(changedCopy));
+
+	// the hint of another memo is not trusted
+	RelationExpressionMemo otherMemo;
+	CHECK(!otherMemo.find(firstCopy));
+	otherMemo.add(firstCopy, RelationExpressionMemo::Value(3));
+	CHECK(otherMemo.find(firstCopy) && otherMemo.find(firstCopy)->size() == 3);
+	CHECK(memo.find(firstCopy) && memo.find(firstCopy)->size() == 1);
+	CHECK(otherMemo.find(firstCopy) && otherMemo.find(firstCopy)->size() == 3);
+
+	// many expressions, some of them with equal hashes of their package names
+	vector< RelationExpression > expressions;
+	for (size_t i = 0; i < 300; ++i)
+	{
+		expressions.push_back(RelationExpression(format2("p%zu (<< %zu) | q", i % 30, i)));
+		memo.add(expressions.back(), RelationExpressionMemo::Value(i + 10));
+	}
+	for (size_t i = 0; i < expressions.size(); ++i)
+	{
+		RelationExpression fresh(format2("p%zu (<< %zu) | q", i % 30, i));
+		CHECK(memo.find(fresh) && memo.find(fresh)->size() == i + 10);
+	}
+
+	memo.clear();
+	CHECK(memo.size() == 0);
+	CHECK(!memo.find(firstCopy));
+	CHECK(!memo.find(expressions[0]));
+
+	return test::failureCount ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
@@ -0,0 +1,158 @@
+/**************************************************************************
+*   Copyright (C) 2026 by agent <agent@local>                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+
+// version keys have to sort exactly as compareVersionStrings() sorts the
+// version strings, both for pooled keys and for keys kept in the versions
+
+#include <cstdlib>
+#include <cstring>
+
+#include <cupt/cache/version.hpp>
+
+#include <internal/versionkey.hpp>
+
+#include "check.hpp"
+
+using namespace cupt;
+using namespace cupt::internal;
+
+namespace {
+
+int getSign(int value)
+{
+	return (value > 0) - (value < 0);
+}
+
+class TestVersion: public cache::Version
+{
+ public:
+	explicit TestVersion(const string& versionString_)
+	{
+		versionString = versionString_;
+	}
+	bool areHashesEqual(const shared_ptr< const Version >&) const
+	{
+		return false;
+	}
+};
+
+// keeps runs reproducible
+uint32_t getRandom(uint32_t limit)
+{
+	static uint32_t state = 12345;
+	state = state * 1103515245 + 12345;
+	return (state >> 16) % limit;
+}
+
+string getRandomPart(const char* alphabet, size_t maxSize)
+{
+	string result;
+	size_t size = getRandom(maxSize) + 1;
+	size_t alphabetSize = strlen(alphabet);
+	for (size_t i = 0; i < size; ++i)
+	{
+		result += alphabet[getRandom(alphabetSize)];
+	}
+	return result;
+}
+
+string getRandomVersionString()
+{
+	string result;
+	if (!getRandom(4))
+	{
+		result += getRandomPart("0123456789", 2) + ':';
+	}
+	result += getRandomPart("0123456789", 2);
+	result += getRandomPart("00123456789.~+aZ", 8);
+	if (getRandom(2))
+	{
+		result += '-' + getRandomPart("00123456789.~+aZ", 4);
+	}
+	return result;
+}
+
+void checkPair(const string& left, const string& right)
+{
+	auto leftKey = versionkey::get(left);
+	auto rightKey = versionkey::get(right);
+	int expected = getSign(compareVersionStrings(left, right));
+	CHECK(getSign(versionkey::compare(leftKey, left, rightKey, right)) == expected);
+	if (leftKey && rightKey)
+	{
+		// pooled: equal keys are the same strings
+		CHECK((leftKey == rightKey) == (expected == 0));
+		CHECK(getSign(leftKey->compare(*rightKey)) == expected);
+	}
+
+	TestVersion leftVersion(left), rightVersion(right);
+	versionkey::set(leftVersion);
+	versionkey::set(rightVersion);
+	CHECK(getSign(versionkey::compare(leftVersion, rightVersion)) == expected);
+	if (leftKey)
+	{
+		auto leftVersionKey = versionkey::get(leftVersion);
+		CHECK(leftVersionKey && *leftVersionKey == *leftKey);
+	}
+}
+
+}
+
+int main()
+{
+	vector< string > versionStrings = {
+		"0", "1", "01", "1.0", "1.00", "1.0~", "1.0~~", "1.0~~a", "1.0~rc1", "1.0a", "1.0A",
+		"1.0+", "1.0.", "1.0+b1", "1.0.1", "1.0-0", "1.0-1", "1.0-1~", "1.0-1+b1", "1.0-1.1",
+		"1.0-a", "0:1.0", "1:1.0", "1:0.9", "2:0", "10:0", "1.0-1-1", "1.0-1-2", "1:1:1",
+		"9", "10", "99", "100", "0009", "1.9", "1.10", "2.6.32-5-amd64", "20120101", "1.0z", "1.0~z",
+		"1.0-0~", "1.0-~", "1.2.3.4.5.6.7.8.9.10.11.12.13.14.15.16.17.18.19.20.21.22.23.24.25.26",
+		"1.2.3.4.5.6.7.8.9.10.11.12.13.14.15.16.17.18.19.20.21.22.23.24.25.27",
+		"1.2.3.4.5.6.7.8.9.10.11.12.13.14.15.16.17.18.19.20.21.22.23.24.25.26~",
+		"1.0\xc3\xa9", "1.0\xc3\xa9-1" // not representable, compared as strings
+	};
+	for (size_t i = 0; i < 2000; ++i)
+	{
+		versionStrings.push_back(getRandomVersionString());
+	}
+
+	CHECK(versionkey::get("1.0") && versionkey::get("1.0") == versionkey::get("1.00"));
+	CHECK(!versionkey::get("1.0\xc3\xa9"));
+	{
+		TestVersion version("1.0\xc3\xa9");
+		versionkey::set(version);
+		CHECK(!versionkey::get(version));
+
+		TestVersion unset("1.0");
+		CHECK(!versionkey::get(unset));
+	}
+
+	for (size_t i = 0; i < 50; ++i)
+	{
+		FORIT(it, versionStrings)
+		{
+			checkPair(versionStrings[i], *it);
+		}
+	}
+	for (size_t i = 50; i + 1 < versionStrings.size(); ++i)
+	{
+		checkPair(versionStrings[i], versionStrings[i+1]);
+	}
+
+	return test::failureCount ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+